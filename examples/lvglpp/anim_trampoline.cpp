@@ -0,0 +1,101 @@
+/* This benchmark compares the per-frame cost of animation callbacks over 500 animations: the former
+   Animation trampoline (dynamic_pointer_cast and copies on every frame), the current Animation
+   trampoline and TypedAnimation */
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "lvglpp/misc/anim.h" // for Animation, TypedAnimation
+
+namespace lvgl::examples {
+
+    using namespace lvgl::misc;
+
+    // Animation's exec trampoline as it was before TypedAnimation got added:
+    // callback and variable are recovered with dynamic_pointer_cast and
+    // copied on every frame. Kept here as the baseline.
+    struct LegacyAnimation {
+        lv_anim_t anim;
+        std::shared_ptr<GenericVariable> var;
+        std::shared_ptr<GenericCallback> exec_cb;
+
+        LegacyAnimation(int32_t & var, void(* exec_cb)(int32_t &, int32_t)) {
+            lv_anim_init(&this->anim);
+            this->var = std::make_shared<Variable<int32_t>>(var);
+            this->exec_cb = std::make_shared<Callback<void, int32_t&, int32_t>>(exec_cb);
+            lv_anim_set_var(&this->anim, static_cast<void*>(this));
+            lv_anim_set_exec_cb(&this->anim, LegacyAnimation::trampoline);
+        }
+
+        static void trampoline(void * lv_obj, int32_t value) {
+            auto anim = reinterpret_cast<LegacyAnimation*>(lv_obj);
+            auto cb = *std::dynamic_pointer_cast<Callback<void, int32_t&, int32_t>>(anim->exec_cb);
+            auto v = *std::dynamic_pointer_cast<Variable<int32_t>>(anim->var);
+            cb(v(), value);
+        }
+
+        lv_anim_t * raw_ptr() {
+            return &this->anim;
+        }
+    };
+
+    void anim_trampoline() {
+        constexpr uint32_t n_anims = 500;
+        constexpr uint32_t n_frames = 1000;
+
+        static std::array<int32_t, n_anims> values;
+        auto set_value = [](int32_t & var, int32_t value) { var = value; };
+
+        // every animation gets started, so that they run concurrently
+        std::vector<std::unique_ptr<Animation>> anims;
+        for (uint32_t n=0; n<n_anims; n++) {
+            auto anim = std::make_unique<Animation>();
+            anim->set_var(values[n]);
+            anim->set_exec_cb<int32_t>(set_value);
+            anim->set_values(0, 1000);
+            anim->set_time(1000);
+            anim->start();
+            anims.push_back(std::move(anim));
+        }
+
+        // not started: LVGL's timer would otherwise run them too
+        std::vector<std::unique_ptr<LegacyAnimation>> legacy_anims;
+        for (uint32_t n=0; n<n_anims; n++)
+            legacy_anims.push_back(std::make_unique<LegacyAnimation>(values[n], set_value));
+
+        using TypedAnim = TypedAnimation<int32_t, decltype(set_value)>;
+        std::vector<std::unique_ptr<TypedAnim>> typed_anims;
+        for (uint32_t n=0; n<n_anims; n++) {
+            auto anim = std::make_unique<TypedAnim>(values[n], set_value);
+            anim->set_values(0, 1000);
+            anim->set_time(1000);
+            anim->start();
+            typed_anims.push_back(std::move(anim));
+        }
+
+        // drive the exec callbacks directly, as LVGL's animation timer would
+        // on each frame; this isolates callback dispatch from timing
+        auto run = [](auto & list) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (uint32_t f=0; f<n_frames; f++) {
+                for (auto & anim : list) {
+                    auto a = anim->raw_ptr();
+                    a->exec_cb(a->var, static_cast<int32_t>(f));
+                }
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+        };
+
+        auto legacy = run(legacy_anims);
+        auto generic = run(anims);
+        auto typed = run(typed_anims);
+
+        LV_LOG_USER("%u animations x %u frames: former Animation %ld us, Animation %ld us, TypedAnimation %ld us",
+                    n_anims, n_frames, static_cast<long>(legacy), static_cast<long>(generic), static_cast<long>(typed));
+
+        // animations are stopped before their wrappers get deleted
+        for (auto & anim : anims)
+            lv_anim_del(anim.get(), nullptr);
+    }
+}
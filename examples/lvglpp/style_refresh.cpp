@@ -0,0 +1,64 @@
+/* This benchmark compares a full style refresh with a targeted one on a tree of 500 objects */
+#include <chrono>
+#include <memory>
+#include "lvglpp/core/display.h" // for scr_act()
+#include "lvglpp/core/object.h" // for Container
+#include "lvglpp/misc/style.h" // for Style, StyleUpdate
+#include "lvglpp/misc/color.h" // for colors
+
+namespace lvgl::examples {
+
+    using namespace lvgl::core;
+    using namespace lvgl::misc;
+
+    void style_refresh() {
+        constexpr uint32_t n_objects = 500;
+        constexpr uint32_t n_rounds = 50;
+
+        static Style style;
+        style.set_bg_color(palette::main(Color::Blue));
+        style.set_size(20);
+        style.set_pad_all(2);
+
+        // a wrapping flex container makes relayout expensive, as it would be
+        // on a real screen
+        auto cnt = std::make_unique<Container>(scr_act());
+        cnt->set_size(lv_pct(100), lv_pct(100));
+        cnt->set_flex_flow(LV_FLEX_FLOW_ROW_WRAP);
+        for (uint32_t n=0; n<n_objects; n++) {
+            auto obj = Container(*cnt);
+            obj.add_style(style, LV_PART_MAIN);
+            // LVGL deletes children with their parent
+            obj.release_ptr();
+        }
+        cnt->update_layout();
+
+        auto run = [&cnt](auto && change) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (uint32_t n=0; n<n_rounds; n++) {
+                change(n);
+                cnt->update_layout();
+            }
+            auto t1 = std::chrono::steady_clock::now();
+            return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / n_rounds;
+        };
+
+        // color change reported with LV_STYLE_PROP_ANY: every object gets
+        // its extended draw size recomputed and its layout invalidated
+        auto full = run([](uint32_t n) {
+            style.set_bg_color(palette::main(n % 2 ? Color::Red : Color::Blue));
+            style.report_style_change();
+        });
+
+        // same change, reporting only the background color
+        auto targeted = run([](uint32_t n) {
+            auto update = StyleUpdate(style);
+            style.set_bg_color(palette::main(n % 2 ? Color::Red : Color::Blue));
+        });
+
+        LV_LOG_USER("%u objects, color change: full refresh %ld us, targeted refresh %ld us",
+                    n_objects, static_cast<long>(full), static_cast<long>(targeted));
+
+        cnt = nullptr;
+    }
+}
@@ -5,8 +5,10 @@
  *  License: MIT
  */
 
+#include <cstring>
 #include "theme.h"
 #include "object.h"
+#include "../misc/style.h"
 
 namespace lvgl::core {
 
@@ -35,6 +37,82 @@ namespace lvgl::core {
         lv_theme_set_apply_cb(this->raw_ptr(), apply_cb);
     }
 
+#if LV_USE_USER_DATA
+    StyleTableTheme::StyleTableTheme() {
+        auto th = this->raw_ptr();
+        auto active = lv_disp_get_theme(nullptr);
+        // inherit display, colors and fonts from active theme
+        if (active != nullptr)
+            *th = *active;
+        else
+            std::memset(th, 0, sizeof(lv_theme_t));
+        th->parent = active;
+        th->user_data = static_cast<void*>(this);
+        lv_theme_set_apply_cb(th, StyleTableTheme::apply);
+    }
+
+    void StyleTableTheme::add_style(const lv_obj_class_t & cls, const Style & style, lv_style_selector_t selector) {
+        this->registered[&cls].push_back({const_cast<lv_style_t*>(style.raw_ptr()), selector});
+        this->resolved.clear();
+    }
+
+    void StyleTableTheme::clear() {
+        this->registered.clear();
+        this->resolved.clear();
+    }
+
+    const StyleTableTheme::StyleList & StyleTableTheme::lookup(const lv_obj_class_t * cls) {
+        auto it = this->resolved.find(cls);
+        if (it != this->resolved.end())
+            return it->second;
+        // flatten styles from the most basic class to the given one
+        std::vector<const lv_obj_class_t*> chain;
+        for (auto c = cls; c != nullptr; c = c->base_class)
+            chain.push_back(c);
+        StyleList styles;
+        for (auto c = chain.rbegin(); c != chain.rend(); c++) {
+            auto r = this->registered.find(*c);
+            if (r != this->registered.end())
+                styles.insert(styles.end(), r->second.begin(), r->second.end());
+        }
+        return this->resolved.emplace(cls, std::move(styles)).first->second;
+    }
+
+    void StyleTableTheme::apply(lv_theme_t * th, lv_obj_t * obj) {
+        auto theme = reinterpret_cast<StyleTableTheme*>(th->user_data);
+        auto & styles = theme->lookup(obj->class_p);
+        if (styles.empty()) return;
+        // this is what lv_obj_add_style does for each style, in one go:
+        // new styles go before the first normal style (after local and
+        // transition styles), the last one added having highest priority
+        uint32_t cnt = obj->style_cnt;
+        uint32_t n_new = styles.size();
+        if (cnt + n_new > 63) {
+            // style_cnt is a 6-bit field; let LVGL deal with it
+            for (auto & s : styles)
+                lv_obj_add_style(obj, s.style, s.selector);
+            return;
+        }
+        uint32_t pos = 0;
+        while (pos < cnt && (obj->styles[pos].is_trans || obj->styles[pos].is_local))
+            pos++;
+        auto obj_styles = static_cast<_lv_obj_style_t*>(
+            lv_mem_realloc(obj->styles, (cnt + n_new) * sizeof(_lv_obj_style_t)));
+        if (obj_styles == nullptr) return;
+        std::memmove(obj_styles + pos + n_new, obj_styles + pos, (cnt - pos) * sizeof(_lv_obj_style_t));
+        for (uint32_t n=0; n<n_new; n++) {
+            auto & entry = obj_styles[pos + n];
+            std::memset(&entry, 0, sizeof(_lv_obj_style_t));
+            entry.style = styles[n_new - 1 - n].style;
+            entry.selector = styles[n_new - 1 - n].selector;
+        }
+        obj->styles = obj_styles;
+        obj->style_cnt = cnt + n_new;
+        // no-op during object creation, where LVGL refreshes styles after theme apply
+        lv_obj_refresh_style(obj, LV_PART_ANY, LV_STYLE_PROP_ANY);
+    }
+#endif // LV_USE_USER_DATA
+
     Theme get_active_theme() {
         return Theme(lv_disp_get_theme(nullptr), false);
     }
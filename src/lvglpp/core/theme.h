@@ -4,9 +4,15 @@
  *  Author: Vincent Paeder
  *  License: MIT
  */
-
+#pragma once
+#include <unordered_map>
+#include <vector>
 #include "../lv_wrapper.h"
 
+namespace lvgl::misc {
+    class Style;
+}
+
 namespace lvgl::core {
 
     class Object;
@@ -49,6 +55,93 @@ namespace lvgl::core {
         void set_apply_cb(lv_theme_apply_cb_t apply_cb);
     };
 
+#if LV_USE_USER_DATA
+    /** \class StyleTableTheme
+     *  \brief A theme that applies styles registered per object class.
+     * 
+     *  Styles are stored in a table indexed by lv_obj_class_t. When an object
+     *  gets created, the theme looks up its class once and inserts all the
+     *  registered styles in a single operation. Styles registered for a base
+     *  class (e.g. lv_obj_class) also apply to derived classes, with lower
+     *  priority than styles registered for the derived class. The flattened
+     *  style list of each class is computed on first use.
+     *  Styles must remain allocated as long as the theme is in use.
+     */
+    class StyleTableTheme : public Theme {
+    private:
+        /** \struct StyleEntry
+         *  \brief A style with its selector.
+         */
+        struct StyleEntry {
+            /** \property lv_style_t * style
+             *  \brief Pointer to style.
+             */
+            lv_style_t * style;
+
+            /** \property lv_style_selector_t selector
+             *  \brief OR-ed combination of parts and states.
+             */
+            lv_style_selector_t selector;
+        };
+
+        /** \typedef StyleList
+         *  \brief List of styles to apply to one class.
+         */
+        using StyleList = std::vector<StyleEntry>;
+
+        /** \property std::unordered_map<const lv_obj_class_t*, StyleList> registered
+         *  \brief Styles registered for each class.
+         */
+        std::unordered_map<const lv_obj_class_t*, StyleList> registered;
+
+        /** \property std::unordered_map<const lv_obj_class_t*, StyleList> resolved
+         *  \brief Styles to apply to each class, including those of base classes.
+         */
+        std::unordered_map<const lv_obj_class_t*, StyleList> resolved;
+
+        /** \fn const StyleList & lookup(const lv_obj_class_t * cls)
+         *  \brief Gets the styles to apply to objects of given class.
+         *  \param cls: object class.
+         *  \returns list of styles.
+         */
+        const StyleList & lookup(const lv_obj_class_t * cls);
+
+        /** \fn static void apply(lv_theme_t * th, lv_obj_t * obj)
+         *  \brief Theme apply callback.
+         *  \param th: pointer to theme.
+         *  \param obj: pointer to created object.
+         */
+        static void apply(lv_theme_t * th, lv_obj_t * obj);
+
+    public:
+        /** \fn StyleTableTheme()
+         *  \brief Constructor. The theme active on the default display,
+         *  if any, is set as parent theme; its styles get applied first.
+         */
+        StyleTableTheme();
+
+        // LVGL holds a pointer to this instance: no copy or move
+        StyleTableTheme(const StyleTableTheme &) = delete;
+        StyleTableTheme & operator=(const StyleTableTheme &) = delete;
+        StyleTableTheme(StyleTableTheme &&) = delete;
+        StyleTableTheme & operator=(StyleTableTheme &&) = delete;
+
+        /** \fn void add_style(const lv_obj_class_t & cls, const misc::Style & style, lv_style_selector_t selector)
+         *  \brief Registers a style for a class. Styles registered later
+         *  take precedence over earlier ones.
+         *  \param cls: object class (e.g. lv_btn_class).
+         *  \param style: style to apply.
+         *  \param selector: OR-ed combination of parts and states.
+         */
+        void add_style(const lv_obj_class_t & cls, const misc::Style & style, lv_style_selector_t selector);
+
+        /** \fn void clear()
+         *  \brief Removes all registered styles.
+         */
+        void clear();
+    };
+#endif // LV_USE_USER_DATA
+
     /** \fn Theme get_active_theme()
      *  \brief Gets active theme on currently active display.
      *  \returns theme object.
@@ -0,0 +1,80 @@
+/** \file atlas.cpp
+ *  \brief Implementation file for packing image sets into a single buffer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <cstring>
+#include "atlas.h"
+
+namespace lvgl::draw {
+
+    ImageAtlas::ImageAtlas(uint32_t align) : align(align > 0 ? align : 1) {}
+
+    size_t ImageAtlas::add(const lv_img_dsc_t & src) {
+        auto img = src;
+        img.data = nullptr;
+        this->images.push_back(img);
+        this->pending.push_back(&src);
+        return this->images.size() - 1;
+    }
+
+    size_t ImageAtlas::add(const ImageDescriptor & src) {
+        return this->add(*src.raw_ptr());
+    }
+
+    void ImageAtlas::build() {
+        if (this->pending.empty()) return;
+        size_t first_pending = this->images.size() - this->pending.size();
+        std::vector<size_t> offsets(this->images.size());
+        size_t total = 0;
+        for (size_t n=0; n<this->images.size(); n++) {
+            total = (total + this->align - 1) & ~static_cast<size_t>(this->align - 1);
+            offsets[n] = total;
+            total += this->images[n].data_size;
+        }
+        std::vector<uint8_t> packed(total);
+        for (size_t n=0; n<this->images.size(); n++) {
+            // already packed images are moved from the previous buffer
+            auto src = n < first_pending ? this->images[n].data : this->pending[n - first_pending]->data;
+            if (src != nullptr)
+                std::memcpy(packed.data() + offsets[n], src, this->images[n].data_size);
+        }
+        bool rebuilt = !this->data.empty();
+        this->data.swap(packed);
+        for (size_t n=0; n<this->images.size(); n++)
+            this->images[n].data = this->data.data() + offsets[n];
+        this->pending.clear();
+        // LVGL may have cached the previous data pointers
+        if (rebuilt)
+            lv_img_cache_invalidate_src(nullptr);
+    }
+
+    ImageDescriptor ImageAtlas::get(size_t index) const {
+        return ImageDescriptor(const_cast<lv_img_dsc_t*>(&this->images[index]), false);
+    }
+
+    std::vector<ImageDescriptor> ImageAtlas::get_range(size_t first, size_t count) const {
+        std::vector<ImageDescriptor> res;
+        res.reserve(count);
+        for (size_t n=first; n<first+count && n<this->images.size(); n++)
+            res.emplace_back(const_cast<lv_img_dsc_t*>(&this->images[n]), false);
+        return res;
+    }
+
+    size_t ImageAtlas::size() const {
+        return this->images.size();
+    }
+
+    size_t ImageAtlas::get_data_size() const {
+        return this->data.size();
+    }
+
+    void ImageAtlas::clear() {
+        this->images.clear();
+        this->pending.clear();
+        this->data.clear();
+        this->data.shrink_to_fit();
+    }
+
+}
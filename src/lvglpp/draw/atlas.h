@@ -0,0 +1,105 @@
+/** \file atlas.h
+ *  \brief Header file for packing image sets into a single buffer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <deque>
+#include <vector>
+#include "image.h"
+
+namespace lvgl::draw {
+
+    /** \class ImageAtlas
+     *  \brief Packs the pixel data of many images into one contiguous
+     *  buffer, with one descriptor per image pointing into it. Images are
+     *  stored one after the other, in insertion order, so images used
+     *  together (e.g. animation frames) end up next to each other.
+     *  Descriptors have stable addresses and can be used with Image,
+     *  ImageButton and AnimatedImage as long as the atlas exists.
+     */
+    class ImageAtlas {
+    private:
+        /** \property std::deque<lv_img_dsc_t> images
+         *  \brief Image descriptors; a deque keeps their addresses stable.
+         */
+        std::deque<lv_img_dsc_t> images;
+
+        /** \property std::vector<const lv_img_dsc_t*> pending
+         *  \brief Sources of images added since last build.
+         */
+        std::vector<const lv_img_dsc_t*> pending;
+
+        /** \property std::vector<uint8_t> data
+         *  \brief Packed pixel data.
+         */
+        std::vector<uint8_t> data;
+
+        /** \property uint32_t align
+         *  \brief Alignment of each image's data, in bytes.
+         */
+        uint32_t align;
+
+    public:
+        /** \fn ImageAtlas(uint32_t align = 4)
+         *  \brief Constructor.
+         *  \param align: alignment of each image's data, in bytes (power of 2).
+         */
+        ImageAtlas(uint32_t align = 4);
+
+        /** \fn size_t add(const lv_img_dsc_t & src)
+         *  \brief Adds an image. Its data is copied by build.
+         *  \param src: image; must stay valid until build is called.
+         *  \returns image index.
+         */
+        size_t add(const lv_img_dsc_t & src);
+
+        /** \fn size_t add(const ImageDescriptor & src)
+         *  \brief Adds an image. Its data is copied by build.
+         *  \param src: image; must stay valid until build is called.
+         *  \returns image index.
+         */
+        size_t add(const ImageDescriptor & src);
+
+        /** \fn void build()
+         *  \brief Copies data of added images into the atlas. Building
+         *  again after adding images reallocates the buffer; descriptors
+         *  stay valid and LVGL's image cache is invalidated.
+         */
+        void build();
+
+        /** \fn ImageDescriptor get(size_t index) const
+         *  \brief Gets a packed image. Descriptor has no data until built.
+         *  \param index: image index.
+         *  \returns non-owning image descriptor.
+         */
+        ImageDescriptor get(size_t index) const;
+
+        /** \fn std::vector<ImageDescriptor> get_range(size_t first, size_t count) const
+         *  \brief Gets consecutive packed images, e.g. animation frames.
+         *  \param first: index of first image.
+         *  \param count: number of images.
+         *  \returns non-owning image descriptors.
+         */
+        std::vector<ImageDescriptor> get_range(size_t first, size_t count) const;
+
+        /** \fn size_t size() const
+         *  \brief Gets the number of images.
+         *  \returns number of images.
+         */
+        size_t size() const;
+
+        /** \fn size_t get_data_size() const
+         *  \brief Gets size of packed data, including alignment padding.
+         *  \returns size in bytes.
+         */
+        size_t get_data_size() const;
+
+        /** \fn void clear()
+         *  \brief Removes all images. Descriptors obtained before become invalid.
+         */
+        void clear();
+    };
+
+}
@@ -0,0 +1,359 @@
+/** \file convert.cpp
+ *  \brief Implementation file for converting raw images to LVGL color formats.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include "convert.h"
+
+namespace lvgl::draw {
+
+    // 4x4 Bayer matrix, values 0..15
+    static const uint8_t bayer[4][4] = {
+        { 0,  8,  2, 10},
+        {12,  4, 14,  6},
+        { 3, 11,  1,  9},
+        {15,  7, 13,  5}
+    };
+
+    using Rgba = std::array<int, 4>;
+
+    // lv_img_header_t stores width and height on 11 bits
+    static constexpr uint32_t max_size = 2047;
+
+    static inline uint16_t get_u16(const uint8_t * p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    static inline uint32_t get_u32(const uint8_t * p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+             | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    // extracts a bit field and scales it to 8 bits
+    static inline uint8_t get_field(uint32_t value, uint32_t mask) {
+        if (mask == 0) return 255;
+        uint32_t shift = 0;
+        while (((mask >> shift) & 1) == 0) shift++;
+        uint32_t max = mask >> shift;
+        return static_cast<uint8_t>(((value & mask) >> shift) * 255 / max);
+    }
+
+    static inline uint32_t get_bpp(lv_img_cf_t cf) {
+        switch (cf) {
+            case LV_IMG_CF_INDEXED_1BIT: case LV_IMG_CF_ALPHA_1BIT: return 1;
+            case LV_IMG_CF_INDEXED_2BIT: case LV_IMG_CF_ALPHA_2BIT: return 2;
+            case LV_IMG_CF_INDEXED_4BIT: case LV_IMG_CF_ALPHA_4BIT: return 4;
+            case LV_IMG_CF_INDEXED_8BIT: case LV_IMG_CF_ALPHA_8BIT: return 8;
+            default: return 0;
+        }
+    }
+
+    ImageConverter::ImageConverter(Dither dither) : dither(dither) {}
+
+    void ImageConverter::set_dither(Dither dither) {
+        this->dither = dither;
+    }
+
+    void ImageConverter::set_palette(const std::vector<lv_color32_t> & palette) {
+        this->palette = palette;
+    }
+
+    std::vector<lv_color32_t> ImageConverter::make_palette(const uint8_t * rgba, size_t count, uint32_t colors) {
+        // large images are sampled, which is enough for a palette
+        size_t step = std::max<size_t>(1, count / 65536);
+        std::vector<std::array<uint8_t, 4>> px;
+        px.reserve(count / step + 1);
+        for (size_t n=0; n<count; n+=step)
+            px.push_back({rgba[4*n], rgba[4*n+1], rgba[4*n+2], rgba[4*n+3]});
+        std::vector<std::pair<size_t, size_t>> boxes;
+        if (!px.empty()) boxes.emplace_back(0, px.size());
+        while (boxes.size() < colors) {
+            // split the box with the widest channel range at its median
+            size_t best = boxes.size();
+            int best_range = 0, best_ch = 0;
+            for (size_t b=0; b<boxes.size(); b++) {
+                for (int ch=0; ch<4; ch++) {
+                    uint8_t lo = 255, hi = 0;
+                    for (size_t n=boxes[b].first; n<boxes[b].second; n++) {
+                        lo = std::min(lo, px[n][ch]);
+                        hi = std::max(hi, px[n][ch]);
+                    }
+                    if (hi - lo > best_range) {
+                        best_range = hi - lo;
+                        best = b;
+                        best_ch = ch;
+                    }
+                }
+            }
+            if (best == boxes.size()) break;
+            auto [first, last] = boxes[best];
+            auto mid = first + (last - first) / 2;
+            std::nth_element(px.begin() + first, px.begin() + mid, px.begin() + last,
+                             [best_ch](const auto & a, const auto & b) { return a[best_ch] < b[best_ch]; });
+            boxes[best] = {first, mid};
+            boxes.emplace_back(mid, last);
+        }
+        std::vector<lv_color32_t> res;
+        for (auto & b : boxes) {
+            uint64_t sum[4] = {0, 0, 0, 0};
+            for (size_t n=b.first; n<b.second; n++)
+                for (int ch=0; ch<4; ch++)
+                    sum[ch] += px[n][ch];
+            size_t len = b.second - b.first;
+            lv_color32_t c;
+            c.ch.red = static_cast<uint8_t>((sum[0] + len/2) / len);
+            c.ch.green = static_cast<uint8_t>((sum[1] + len/2) / len);
+            c.ch.blue = static_cast<uint8_t>((sum[2] + len/2) / len);
+            c.ch.alpha = static_cast<uint8_t>((sum[3] + len/2) / len);
+            res.push_back(c);
+        }
+        return res;
+    }
+
+    ImageDescriptor ImageConverter::convert(const uint8_t * rgba, uint32_t w, uint32_t h, lv_img_cf_t cf) const {
+        bool true_color = cf == LV_IMG_CF_TRUE_COLOR || cf == LV_IMG_CF_TRUE_COLOR_ALPHA
+                       || cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+        bool indexed = cf >= LV_IMG_CF_INDEXED_1BIT && cf <= LV_IMG_CF_INDEXED_8BIT;
+        uint32_t bpp = get_bpp(cf);
+        if (rgba == nullptr || w == 0 || h == 0 || w > max_size || h > max_size || (!true_color && bpp == 0))
+            return ImageDescriptor();
+        ImageDescriptor res(static_cast<lv_coord_t>(w), static_cast<lv_coord_t>(h), cf);
+        if (res.raw_ptr() == nullptr || res.raw_ptr()->data == nullptr)
+            return ImageDescriptor();
+        auto out = const_cast<uint8_t*>(res.raw_ptr()->data);
+
+        // quantization step of each channel, used to scale ordered dithering
+        Rgba spread = {0, 0, 0, 0};
+        std::vector<lv_color32_t> pal;
+        if (true_color) {
+#if LV_COLOR_DEPTH == 16
+            spread = {8, 4, 8, 0};
+#elif LV_COLOR_DEPTH == 8
+            spread = {32, 32, 64, 0};
+#elif LV_COLOR_DEPTH == 1
+            spread = {255, 255, 255, 0};
+#endif
+        } else if (indexed) {
+            uint32_t colors = 1u << bpp;
+            pal = this->palette.empty() ? make_palette(rgba, static_cast<size_t>(w) * h, colors) : this->palette;
+            if (pal.size() > colors) pal.resize(colors);
+            if (pal.empty()) pal.push_back(lv_color32_t{});
+            std::memcpy(out, pal.data(), pal.size() * sizeof(lv_color32_t));
+            out += colors * sizeof(lv_color32_t);
+            int s = 256 / std::max(2, static_cast<int>(std::lround(std::cbrt(static_cast<double>(pal.size())))));
+            // alpha isn't dithered, so that opaque images stay opaque
+            spread = {s, s, s, 0};
+        } else {
+            spread = {0, 0, 0, 255 / ((1 << bpp) - 1)};
+        }
+
+        // nearest palette entry, with a small direct-mapped cache; keys are
+        // stored plus one, so that 0 marks an empty slot and no color
+        // (opaque white included) matches it
+        std::vector<uint64_t> cache_key(indexed ? 4096 : 0, 0);
+        std::vector<uint8_t> cache_index(cache_key.size());
+        auto nearest = [&pal, &cache_key, &cache_index](const Rgba & v) -> uint8_t {
+            uint32_t key = static_cast<uint32_t>(v[0]) | (v[1] << 8) | (v[2] << 16) | (static_cast<uint32_t>(v[3]) << 24);
+            uint32_t slot = (key * 2654435761u) >> 20;
+            if (cache_key[slot] == static_cast<uint64_t>(key) + 1) return cache_index[slot];
+            uint32_t best = 0, best_dist = UINT32_MAX;
+            for (uint32_t n=0; n<pal.size(); n++) {
+                int dr = v[0] - pal[n].ch.red, dg = v[1] - pal[n].ch.green;
+                int db = v[2] - pal[n].ch.blue, da = v[3] - pal[n].ch.alpha;
+                uint32_t dist = dr*dr + dg*dg + db*db + da*da;
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = n;
+                }
+            }
+            cache_key[slot] = static_cast<uint64_t>(key) + 1;
+            cache_index[slot] = static_cast<uint8_t>(best);
+            return static_cast<uint8_t>(best);
+        };
+
+        uint32_t stride = true_color ? 0 : (w * bpp + 7) / 8;
+        size_t px_size = cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+        // error diffusion rows, with one pixel of margin on each side
+        std::vector<Rgba> err_cur, err_next;
+        if (this->dither == Dither::FloydSteinberg) {
+            err_cur.assign(w + 2, Rgba{0, 0, 0, 0});
+            err_next.assign(w + 2, Rgba{0, 0, 0, 0});
+        }
+        if (!true_color)
+            std::memset(out, 0, static_cast<size_t>(stride) * h);
+
+        for (uint32_t y=0; y<h; y++) {
+            for (uint32_t x=0; x<w; x++) {
+                auto src = rgba + (static_cast<size_t>(y) * w + x) * 4;
+                Rgba v = {src[0], src[1], src[2], src[3]};
+                for (int ch=0; ch<4; ch++) {
+                    if (this->dither == Dither::FloydSteinberg)
+                        v[ch] += err_cur[x + 1][ch] / 16;
+                    else if (this->dither == Dither::Ordered)
+                        v[ch] += (bayer[y & 3][x & 3] * 2 - 15) * spread[ch] / 32;
+                    v[ch] = std::clamp(v[ch], 0, 255);
+                }
+                Rgba q = v;
+                if (true_color) {
+                    auto c = lv_color_make(v[0], v[1], v[2]);
+                    uint32_t c32 = lv_color_to32(c);
+                    q[0] = (c32 >> 16) & 0xFF;
+                    q[1] = (c32 >> 8) & 0xFF;
+                    q[2] = c32 & 0xFF;
+                    if (cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED && v[3] < 128) {
+                        c = LV_COLOR_CHROMA_KEY;
+                        q = v;
+                    }
+                    auto dst = out + (static_cast<size_t>(y) * w + x) * px_size;
+                    std::memcpy(dst, &c, sizeof(c));
+                    if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA)
+                        dst[sizeof(lv_color_t)] = static_cast<uint8_t>(v[3]);
+                } else {
+                    uint32_t code;
+                    if (indexed) {
+                        code = nearest(v);
+                        q = {pal[code].ch.red, pal[code].ch.green, pal[code].ch.blue, pal[code].ch.alpha};
+                    } else {
+                        uint32_t levels = (1u << bpp) - 1;
+                        code = (v[3] * levels + 127) / 255;
+                        q[3] = code * 255 / levels;
+                    }
+                    // pixels are packed from the most significant bit
+                    auto bit = x * bpp;
+                    out[y * stride + bit / 8] |= static_cast<uint8_t>(code << (8 - bpp - bit % 8));
+                }
+                if (this->dither == Dither::FloydSteinberg) {
+                    for (int ch=0; ch<4; ch++) {
+                        int e = v[ch] - q[ch];
+                        err_cur[x + 2][ch] += e * 7;
+                        err_next[x][ch] += e * 3;
+                        err_next[x + 1][ch] += e * 5;
+                        err_next[x + 2][ch] += e;
+                    }
+                }
+            }
+            if (this->dither == Dither::FloydSteinberg) {
+                err_cur.swap(err_next);
+                std::fill(err_next.begin(), err_next.end(), Rgba{0, 0, 0, 0});
+            }
+        }
+        return res;
+    }
+
+    bool ImageConverter::load_bmp(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h) {
+        if (size < 54 || data[0] != 'B' || data[1] != 'M') return false;
+        uint32_t offset = get_u32(data + 10);
+        uint32_t dib_size = get_u32(data + 14);
+        int32_t width = static_cast<int32_t>(get_u32(data + 18));
+        int32_t height = static_cast<int32_t>(get_u32(data + 22));
+        uint16_t bpp = get_u16(data + 28);
+        uint32_t compression = get_u32(data + 30);
+        // offsets are checked before forming pointers from them
+        if (dib_size < 40 || dib_size > size - 14) return false;
+        if (width <= 0 || width > static_cast<int32_t>(max_size)) return false;
+        if (height == 0 || height > static_cast<int32_t>(max_size) || height < -static_cast<int32_t>(max_size)) return false;
+        bool bottom_up = height > 0;
+        w = static_cast<uint32_t>(width);
+        h = static_cast<uint32_t>(bottom_up ? height : -height);
+        // masks for 32-bit pixels: stored after a 40-byte header with
+        // BI_BITFIELDS, or within larger headers (alpha from 56 bytes on)
+        uint32_t masks[4] = {0x00FF0000, 0x0000FF00, 0x000000FF, 0};
+        if (compression == 3 && bpp == 32 && size >= 14 + 40 + 12) {
+            for (int n=0; n<3; n++) masks[n] = get_u32(data + 54 + 4*n);
+            if (dib_size >= 56) masks[3] = get_u32(data + 66);
+        } else if (compression != 0) {
+            return false;
+        }
+        if (bpp != 8 && bpp != 24 && bpp != 32) return false;
+        size_t palette_pos = 14 + static_cast<size_t>(dib_size);
+        uint32_t palette_size = get_u32(data + 46);
+        if (bpp == 8) {
+            if (palette_size == 0 || palette_size > 256) palette_size = 256;
+            if (static_cast<size_t>(palette_size) * 4 > size - palette_pos) return false;
+        }
+        const uint8_t * palette = data + palette_pos;
+        size_t stride = (static_cast<size_t>(bpp) * w + 31) / 32 * 4;
+        if (offset > size || stride * h > size - offset) return false;
+        rgba.resize(static_cast<size_t>(w) * h * 4);
+        for (uint32_t y=0; y<h; y++) {
+            auto row = data + offset + stride * (bottom_up ? h - 1 - y : y);
+            auto dst = rgba.data() + static_cast<size_t>(y) * w * 4;
+            for (uint32_t x=0; x<w; x++, dst+=4) {
+                if (bpp == 8) {
+                    uint8_t idx = row[x];
+                    if (idx >= palette_size) idx = 0;
+                    auto p = palette + idx * 4;
+                    dst[0] = p[2]; dst[1] = p[1]; dst[2] = p[0]; dst[3] = 255;
+                } else if (bpp == 24) {
+                    auto p = row + x * 3;
+                    dst[0] = p[2]; dst[1] = p[1]; dst[2] = p[0]; dst[3] = 255;
+                } else {
+                    uint32_t px = get_u32(row + x * 4);
+                    dst[0] = get_field(px, masks[0]);
+                    dst[1] = get_field(px, masks[1]);
+                    dst[2] = get_field(px, masks[2]);
+                    dst[3] = get_field(px, masks[3]);
+                }
+            }
+        }
+        return true;
+    }
+
+    bool ImageConverter::load_ppm(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h) {
+        if (size < 3 || data[0] != 'P' || (data[1] != '5' && data[1] != '6')) return false;
+        bool gray = data[1] == '5';
+        size_t pos = 2;
+        // header: width, height and maximum value, with optional comments
+        uint32_t values[3];
+        for (auto & value : values) {
+            while (pos < size && (std::isspace(data[pos]) || data[pos] == '#')) {
+                if (data[pos] == '#')
+                    while (pos < size && data[pos] != '\n') pos++;
+                else
+                    pos++;
+            }
+            if (pos >= size || !std::isdigit(data[pos])) return false;
+            value = 0;
+            while (pos < size && std::isdigit(data[pos]) && value < 100000)
+                value = value * 10 + (data[pos++] - '0');
+        }
+        pos++;
+        w = values[0];
+        h = values[1];
+        uint32_t max = values[2];
+        if (w == 0 || h == 0 || w > max_size || h > max_size || max == 0 || max > 255) return false;
+        size_t channels = gray ? 1 : 3;
+        if (pos + static_cast<size_t>(w) * h * channels > size) return false;
+        rgba.resize(static_cast<size_t>(w) * h * 4);
+        auto src = data + pos;
+        for (size_t n=0; n<static_cast<size_t>(w) * h; n++, src+=channels) {
+            for (size_t ch=0; ch<3; ch++)
+                rgba[4*n + ch] = static_cast<uint8_t>(src[gray ? 0 : ch] * 255 / max);
+            rgba[4*n + 3] = 255;
+        }
+        return true;
+    }
+
+    ImageDescriptor ImageConverter::convert_bmp(const uint8_t * data, size_t size, lv_img_cf_t cf) const {
+        std::vector<uint8_t> rgba;
+        uint32_t w, h;
+        if (!load_bmp(data, size, rgba, w, h))
+            return ImageDescriptor();
+        return this->convert(rgba.data(), w, h, cf);
+    }
+
+    ImageDescriptor ImageConverter::convert_ppm(const uint8_t * data, size_t size, lv_img_cf_t cf) const {
+        std::vector<uint8_t> rgba;
+        uint32_t w, h;
+        if (!load_ppm(data, size, rgba, w, h))
+            return ImageDescriptor();
+        return this->convert(rgba.data(), w, h, cf);
+    }
+
+}
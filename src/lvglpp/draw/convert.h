@@ -0,0 +1,127 @@
+/** \file convert.h
+ *  \brief Header file for converting raw images to LVGL color formats.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <vector>
+#include "image.h"
+
+namespace lvgl::draw {
+
+    /** \class ImageConverter
+     *  \brief Converts 8-bit RGBA pixel buffers, BMP files (24/32-bit, or
+     *  8-bit indexed, uncompressed) and PPM/PGM files (binary) to any true
+     *  color, indexed or alpha-only LVGL color format. Palettes of indexed
+     *  formats are computed by median cut, unless a palette is given.
+     *  Quantization can be dithered with a 4x4 ordered pattern or
+     *  Floyd-Steinberg error diffusion.
+     */
+    class ImageConverter {
+    public:
+        /** \enum Dither
+         *  \brief Dithering method.
+         */
+        enum class Dither {
+            None,
+            Ordered,
+            FloydSteinberg
+        };
+
+    private:
+        /** \property Dither dither
+         *  \brief Dithering method.
+         */
+        Dither dither = Dither::None;
+
+        /** \property std::vector<lv_color32_t> palette
+         *  \brief Fixed palette for indexed formats; computed per image if empty.
+         */
+        std::vector<lv_color32_t> palette;
+
+    public:
+        /** \fn ImageConverter(Dither dither = Dither::None)
+         *  \brief Constructor.
+         *  \param dither: dithering method.
+         */
+        ImageConverter(Dither dither = Dither::None);
+
+        /** \fn void set_dither(Dither dither)
+         *  \brief Sets dithering method.
+         *  \param dither: dithering method.
+         */
+        void set_dither(Dither dither);
+
+        /** \fn void set_palette(const std::vector<lv_color32_t> & palette)
+         *  \brief Sets a fixed palette for indexed formats. Extra colors are
+         *  ignored. An empty palette restores palette computation.
+         *  \param palette: palette colors.
+         */
+        void set_palette(const std::vector<lv_color32_t> & palette);
+
+        /** \fn ImageDescriptor convert(const uint8_t * rgba, uint32_t w, uint32_t h, lv_img_cf_t cf) const
+         *  \brief Converts an RGBA buffer.
+         *  \param rgba: pixels, 4 bytes each (red, green, blue, alpha), row by row.
+         *  \param w: image width.
+         *  \param h: image height.
+         *  \param cf: target color format; LV_IMG_CF_TRUE_COLOR*,
+         *  LV_IMG_CF_INDEXED_* or LV_IMG_CF_ALPHA_*.
+         *  \returns converted image; without data if format isn't supported
+         *  or image is larger than 2047x2047 pixels.
+         */
+        ImageDescriptor convert(const uint8_t * rgba, uint32_t w, uint32_t h, lv_img_cf_t cf) const;
+
+        /** \fn ImageDescriptor convert_bmp(const uint8_t * data, size_t size, lv_img_cf_t cf) const
+         *  \brief Converts a BMP file.
+         *  \param data: file content.
+         *  \param size: file size, in bytes.
+         *  \param cf: target color format.
+         *  \returns converted image; without data if failed.
+         */
+        ImageDescriptor convert_bmp(const uint8_t * data, size_t size, lv_img_cf_t cf) const;
+
+        /** \fn ImageDescriptor convert_ppm(const uint8_t * data, size_t size, lv_img_cf_t cf) const
+         *  \brief Converts a PPM (P6) or PGM (P5) file.
+         *  \param data: file content.
+         *  \param size: file size, in bytes.
+         *  \param cf: target color format.
+         *  \returns converted image; without data if failed.
+         */
+        ImageDescriptor convert_ppm(const uint8_t * data, size_t size, lv_img_cf_t cf) const;
+
+        /** \fn static bool load_bmp(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h)
+         *  \brief Decodes a BMP file to RGBA.
+         *  \param data: file content.
+         *  \param size: file size, in bytes.
+         *  \param rgba: receives pixels.
+         *  \param w: receives image width.
+         *  \param h: receives image height.
+         *  \returns true if successful, false otherwise, e.g. if image is
+         *  larger than 2047x2047 pixels.
+         */
+        static bool load_bmp(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h);
+
+        /** \fn static bool load_ppm(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h)
+         *  \brief Decodes a PPM (P6) or PGM (P5) file to RGBA.
+         *  \param data: file content.
+         *  \param size: file size, in bytes.
+         *  \param rgba: receives pixels.
+         *  \param w: receives image width.
+         *  \param h: receives image height.
+         *  \returns true if successful, false otherwise, e.g. if image is
+         *  larger than 2047x2047 pixels.
+         */
+        static bool load_ppm(const uint8_t * data, size_t size, std::vector<uint8_t> & rgba, uint32_t & w, uint32_t & h);
+
+        /** \fn static std::vector<lv_color32_t> make_palette(const uint8_t * rgba, size_t count, uint32_t colors)
+         *  \brief Computes a palette by median cut.
+         *  \param rgba: pixels, 4 bytes each.
+         *  \param count: number of pixels.
+         *  \param colors: maximum number of colors.
+         *  \returns palette.
+         */
+        static std::vector<lv_color32_t> make_palette(const uint8_t * rgba, size_t count, uint32_t colors);
+    };
+
+}
@@ -0,0 +1,186 @@
+/** \file decoder.cpp
+ *  \brief Implementation file for custom image decoders registered with LVGL.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <cstring>
+#include "decoder.h"
+
+// we need user_data to store pointer to C++ object, otherwise we cannot
+// access callbacks defined as class members.
+#if LV_USE_USER_DATA
+
+namespace lvgl::draw {
+
+    CustomImageDecoder::CustomImageDecoder() {
+        this->lv_obj = LvPointerType(lv_img_decoder_create());
+        this->lv_obj->user_data = static_cast<void*>(this);
+        auto f_info = [](lv_cls_ptr decoder, const void * src, lv_img_header_t * header) -> lv_res_t {
+            auto obj = static_cast<CustomImageDecoder*>(decoder->user_data);
+            return obj->info_cb(src, header);
+        };
+        auto f_open = [](lv_cls_ptr decoder, lv_img_decoder_dsc_t * dsc) -> lv_res_t {
+            auto obj = static_cast<CustomImageDecoder*>(decoder->user_data);
+            return obj->open_cb(dsc);
+        };
+        auto f_read_line = [](lv_cls_ptr decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y,
+                              lv_coord_t len, uint8_t * buf) -> lv_res_t {
+            auto obj = static_cast<CustomImageDecoder*>(decoder->user_data);
+            return obj->read_line_cb(dsc, x, y, len, buf);
+        };
+        auto f_close = [](lv_cls_ptr decoder, lv_img_decoder_dsc_t * dsc) {
+            auto obj = static_cast<CustomImageDecoder*>(decoder->user_data);
+            obj->close_cb(dsc);
+        };
+        lv_img_decoder_set_info_cb(this->raw_ptr(), f_info);
+        lv_img_decoder_set_open_cb(this->raw_ptr(), f_open);
+        lv_img_decoder_set_read_line_cb(this->raw_ptr(), f_read_line);
+        lv_img_decoder_set_close_cb(this->raw_ptr(), f_close);
+    }
+
+    lv_res_t CustomImageDecoder::read_line_cb(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf) {
+        return LV_RES_INV;
+    }
+
+    void CustomImageDecoder::close_cb(lv_img_decoder_dsc_t * dsc) {}
+
+
+    static constexpr uint8_t rle_version = 1;
+
+    bool RleImageDecoder::get_header(const lv_img_dsc_t * img, Header & header) {
+        if (img->data == nullptr || img->data_size < sizeof(Header)) return false;
+        if (img->header.cf != LV_IMG_CF_RAW && img->header.cf != LV_IMG_CF_RAW_ALPHA
+            && img->header.cf != LV_IMG_CF_RAW_CHROMA_KEYED) return false;
+        std::memcpy(&header, img->data, sizeof(Header));
+        return std::memcmp(header.magic, "LVRL", 4) == 0 && header.version == rle_version
+            && img->data_size >= sizeof(Header) + header.h * sizeof(uint32_t);
+    }
+
+    lv_res_t RleImageDecoder::info_cb(const void * src, lv_img_header_t * header) {
+        if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) return LV_RES_INV;
+        Header h;
+        if (!get_header(static_cast<const lv_img_dsc_t*>(src), h)) return LV_RES_INV;
+        header->always_zero = 0;
+        header->w = h.w;
+        header->h = h.h;
+        header->cf = h.cf;
+        return LV_RES_OK;
+    }
+
+    lv_res_t RleImageDecoder::open_cb(lv_img_decoder_dsc_t * dsc) {
+        if (dsc->src_type != LV_IMG_SRC_VARIABLE) return LV_RES_INV;
+        Header h;
+        if (!get_header(static_cast<const lv_img_dsc_t*>(dsc->src), h)) return LV_RES_INV;
+        // lines are decoded on demand
+        dsc->img_data = nullptr;
+        return LV_RES_OK;
+    }
+
+    lv_res_t RleImageDecoder::read_line_cb(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf) {
+        auto img = static_cast<const lv_img_dsc_t*>(dsc->src);
+        Header h;
+        std::memcpy(&h, img->data, sizeof(Header));
+        if (y < 0 || y >= h.h || x < 0 || x + len > h.w) return LV_RES_INV;
+        auto lines = img->data + sizeof(Header) + h.h * sizeof(uint32_t);
+        uint32_t offset;
+        std::memcpy(&offset, img->data + sizeof(Header) + y * sizeof(uint32_t), sizeof(offset));
+        auto p = lines + offset;
+        auto end = img->data + img->data_size;
+        const size_t px_size = h.px_size;
+        lv_coord_t skip = x;
+        while (len > 0 && p < end) {
+            uint8_t c = *p++;
+            lv_coord_t count = c < 128 ? c + 1 : c - 126;
+            // pixels before x are skipped
+            lv_coord_t skipped = std::min(skip, count);
+            lv_coord_t n = std::min<lv_coord_t>(count - skipped, len);
+            if (c < 128) {
+                // literal pixels
+                if (p + count * px_size > end) return LV_RES_INV;
+                std::memcpy(buf, p + skipped * px_size, n * px_size);
+                buf += n * px_size;
+                p += count * px_size;
+            } else {
+                // repeated pixel
+                if (p + px_size > end) return LV_RES_INV;
+                for (lv_coord_t i=0; i<n; i++) {
+                    std::memcpy(buf, p, px_size);
+                    buf += px_size;
+                }
+                p += px_size;
+            }
+            skip -= skipped;
+            len -= n;
+        }
+        return len == 0 ? LV_RES_OK : LV_RES_INV;
+    }
+
+    std::vector<uint8_t> RleImageDecoder::encode(const lv_img_dsc_t & src) {
+        uint8_t px_size;
+        switch (src.header.cf) {
+            case LV_IMG_CF_TRUE_COLOR:
+            case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+                px_size = sizeof(lv_color_t);
+                break;
+            case LV_IMG_CF_TRUE_COLOR_ALPHA:
+                px_size = LV_IMG_PX_SIZE_ALPHA_BYTE;
+                break;
+            default:
+                return {};
+        }
+        uint16_t w = src.header.w;
+        uint16_t h = src.header.h;
+        if (src.data == nullptr || src.data_size < static_cast<uint32_t>(w) * h * px_size) return {};
+        Header header{{'L', 'V', 'R', 'L'}, rle_version, px_size, static_cast<uint8_t>(src.header.cf), 0, w, h};
+        std::vector<uint8_t> out(sizeof(Header) + h * sizeof(uint32_t));
+        std::memcpy(out.data(), &header, sizeof(Header));
+        size_t lines_start = out.size();
+        auto same = [px_size](const uint8_t * a, const uint8_t * b) { return std::memcmp(a, b, px_size) == 0; };
+        for (uint16_t y=0; y<h; y++) {
+            uint32_t offset = out.size() - lines_start;
+            std::memcpy(out.data() + sizeof(Header) + y * sizeof(uint32_t), &offset, sizeof(offset));
+            auto line = src.data + static_cast<size_t>(y) * w * px_size;
+            uint16_t x = 0;
+            while (x < w) {
+                // repeated pixel: at least 2 identical pixels, up to 129
+                uint16_t run = 1;
+                while (x + run < w && run < 129 && same(line + x * px_size, line + (x + run) * px_size))
+                    run++;
+                if (run >= 2) {
+                    out.push_back(static_cast<uint8_t>(run + 126));
+                    out.insert(out.end(), line + x * px_size, line + (x + 1) * px_size);
+                    x += run;
+                    continue;
+                }
+                // literal pixels, until next pair of identical pixels, up to 128
+                uint16_t count = 1;
+                while (x + count < w && count < 128
+                       && !(x + count + 1 < w && same(line + (x + count) * px_size, line + (x + count + 1) * px_size)))
+                    count++;
+                out.push_back(static_cast<uint8_t>(count - 1));
+                out.insert(out.end(), line + x * px_size, line + (x + count) * px_size);
+                x += count;
+            }
+        }
+        return out;
+    }
+
+    std::vector<uint8_t> RleImageDecoder::encode(const ImageDescriptor & src) {
+        return encode(*src.raw_ptr());
+    }
+
+    bool RleImageDecoder::set_src(ImageDescriptor & dsc, const std::vector<uint8_t> & data) {
+        if (data.size() < sizeof(Header)) return false;
+        Header h;
+        std::memcpy(&h, data.data(), sizeof(Header));
+        if (std::memcmp(h.magic, "LVRL", 4) != 0 || h.version != rle_version) return false;
+        lv_img_cf_t cf = h.cf == LV_IMG_CF_TRUE_COLOR_ALPHA ? LV_IMG_CF_RAW_ALPHA
+                       : h.cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED ? LV_IMG_CF_RAW_CHROMA_KEYED : LV_IMG_CF_RAW;
+        dsc.set_src(data, h.w, h.h, cf);
+        return true;
+    }
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,165 @@
+/** \file decoder.h
+ *  \brief Header file for custom image decoders registered with LVGL.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <vector>
+#include "image.h"
+
+// we need user_data to store pointer to C++ object, otherwise we cannot
+// access callbacks defined as class members.
+#if LV_USE_USER_DATA
+
+namespace lvgl::draw {
+
+    /** \class CustomImageDecoder
+     *  \brief Wraps a lv_img_decoder_t object. This is a base class to
+     *  register an image decoder with LVGL. The decoder is registered on
+     *  construction, ahead of previously registered ones, and removed on
+     *  destruction.
+     */
+    class CustomImageDecoder : public PointerWrapper<lv_img_decoder_t, lv_img_decoder_delete> {
+    protected:
+        /** \fn virtual lv_res_t info_cb(const void * src, lv_img_header_t * header)
+         *  \brief Callback to read image info. Decoders that don't handle the
+         *  source must return LV_RES_INV.
+         *  \param src: image source (see lv_img_src_get_type).
+         *  \param header: pointer to the recipient image header.
+         *  \returns result code.
+         */
+        virtual lv_res_t info_cb(const void * src, lv_img_header_t * header) = 0;
+
+        /** \fn virtual lv_res_t open_cb(lv_img_decoder_dsc_t * dsc)
+         *  \brief Callback to open image. It either sets dsc->img_data to the
+         *  fully decoded image, or leaves it null to have lines read with
+         *  read_line_cb.
+         *  \param dsc: image decoder descriptor, with header already filled.
+         *  \returns result code.
+         */
+        virtual lv_res_t open_cb(lv_img_decoder_dsc_t * dsc) = 0;
+
+        /** \fn virtual lv_res_t read_line_cb(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf)
+         *  \brief Callback to decode part of a line. Pixels are lv_color_t,
+         *  followed by an alpha byte if image format has alpha.
+         *  \param dsc: image decoder descriptor.
+         *  \param x: horizontal coordinate.
+         *  \param y: vertical coordinate.
+         *  \param len: number of pixels to decode.
+         *  \param buf: pointer to the recipient buffer.
+         *  \returns result code.
+         */
+        virtual lv_res_t read_line_cb(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf);
+
+        /** \fn virtual void close_cb(lv_img_decoder_dsc_t * dsc)
+         *  \brief Callback to close image, freeing what open_cb allocated.
+         *  \param dsc: image decoder descriptor.
+         */
+        virtual void close_cb(lv_img_decoder_dsc_t * dsc);
+
+    public:
+        /** \fn CustomImageDecoder()
+         *  \brief Constructor. Registers decoder with LVGL.
+         */
+        CustomImageDecoder();
+
+        // LVGL holds a pointer to this instance: no copy or move
+        CustomImageDecoder(const CustomImageDecoder &) = delete;
+        CustomImageDecoder & operator=(const CustomImageDecoder &) = delete;
+        CustomImageDecoder(CustomImageDecoder &&) = delete;
+        CustomImageDecoder & operator=(CustomImageDecoder &&) = delete;
+    };
+
+    /** \class RleImageDecoder
+     *  \brief Decoder for run-length encoded true color images stored in
+     *  memory, decoded line by line during rendering. Encoded images are
+     *  produced by encode and referenced by descriptors with a
+     *  LV_IMG_CF_RAW* color format (see set_src). Each line is indexed, so
+     *  any line can be decoded without decoding the previous ones.
+     */
+    class RleImageDecoder : public CustomImageDecoder {
+    private:
+        /** \struct Header
+         *  \brief Encoded image header, followed by one 32-bit offset per
+         *  line (relative to end of offset table), then encoded lines.
+         */
+        struct Header {
+            /** \property char magic[4]
+             *  \brief Format identifier, "LVRL".
+             */
+            char magic[4];
+
+            /** \property uint8_t version
+             *  \brief Format version.
+             */
+            uint8_t version;
+
+            /** \property uint8_t px_size
+             *  \brief Pixel size, in bytes.
+             */
+            uint8_t px_size;
+
+            /** \property uint8_t cf
+             *  \brief Decoded color format.
+             */
+            uint8_t cf;
+
+            /** \property uint8_t reserved
+             *  \brief Padding.
+             */
+            uint8_t reserved;
+
+            /** \property uint16_t w
+             *  \brief Image width.
+             */
+            uint16_t w;
+
+            /** \property uint16_t h
+             *  \brief Image height.
+             */
+            uint16_t h;
+        };
+
+        /** \fn static bool get_header(const lv_img_dsc_t * img, Header & header)
+         *  \brief Reads and checks encoded image header.
+         *  \param img: image descriptor.
+         *  \param header: recipient header.
+         *  \returns true if image is RLE-encoded, false otherwise.
+         */
+        static bool get_header(const lv_img_dsc_t * img, Header & header);
+
+    protected:
+        lv_res_t info_cb(const void * src, lv_img_header_t * header) override;
+        lv_res_t open_cb(lv_img_decoder_dsc_t * dsc) override;
+        lv_res_t read_line_cb(lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t * buf) override;
+
+    public:
+        /** \fn static std::vector<uint8_t> encode(const lv_img_dsc_t & src)
+         *  \brief Encodes an image. Runs are a control byte c followed by
+         *  c+1 literal pixels (c < 128), or by one pixel repeated c-126 times.
+         *  \param src: image in LV_IMG_CF_TRUE_COLOR, LV_IMG_CF_TRUE_COLOR_ALPHA
+         *  or LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED format.
+         *  \returns encoded image, or empty vector if format isn't supported.
+         */
+        static std::vector<uint8_t> encode(const lv_img_dsc_t & src);
+
+        /** \fn static std::vector<uint8_t> encode(const ImageDescriptor & src)
+         *  \brief Encodes an image.
+         *  \param src: image in LV_IMG_CF_TRUE_COLOR, LV_IMG_CF_TRUE_COLOR_ALPHA
+         *  or LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED format.
+         *  \returns encoded image, or empty vector if format isn't supported.
+         */
+        static std::vector<uint8_t> encode(const ImageDescriptor & src);
+
+        /** \fn static bool set_src(ImageDescriptor & dsc, const std::vector<uint8_t> & data)
+         *  \brief Points an image descriptor to an encoded image.
+         *  \param dsc: image descriptor.
+         *  \param data: encoded image; must outlive descriptor.
+         *  \returns true if data is a valid encoded image, false otherwise.
+         */
+        static bool set_src(ImageDescriptor & dsc, const std::vector<uint8_t> & data);
+    };
+
+}
+#endif // LV_USE_USER_DATA
@@ -5,9 +5,169 @@
  *  Author: Vincent Paeder
  *  License: MIT
  */
+#include <algorithm>
+#include <cstring>
 #include "image.h"
+#if LV_COLOR_DEPTH == 32 && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace lvgl::draw {
+
+    // bytes per pixel of true color formats, 0 for other formats
+    static inline uint32_t get_true_color_size(lv_img_cf_t cf) {
+        switch (cf) {
+            case LV_IMG_CF_TRUE_COLOR:
+            case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+                return sizeof(lv_color_t);
+            case LV_IMG_CF_TRUE_COLOR_ALPHA:
+                return LV_IMG_PX_SIZE_ALPHA_BYTE;
+            default:
+                return 0;
+        }
+    }
+
+    // pixels with alpha aren't aligned to lv_color_t
+    static inline lv_color_t load_color(const uint8_t * p) {
+        lv_color_t c;
+        std::memcpy(&c, p, sizeof(lv_color_t));
+        return c;
+    }
+
+    static inline void store_color(uint8_t * p, lv_color_t c) {
+        std::memcpy(p, &c, sizeof(lv_color_t));
+    }
+
+    // alpha of a true color pixel; at 32 bits it is the color's own alpha byte
+    static inline lv_opa_t load_alpha(const uint8_t * p, lv_img_cf_t cf) {
+        if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) return p[LV_IMG_PX_SIZE_ALPHA_BYTE - 1];
+        if (cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED)
+            return load_color(p).full == LV_COLOR_CHROMA_KEY.full ? LV_OPA_TRANSP : LV_OPA_COVER;
+        return LV_OPA_COVER;
+    }
+
+    // clips an area to an image; returns false if nothing is left
+    static inline bool clip_area(lv_area_t & area, const lv_img_dsc_t * dsc) {
+        area.x1 = std::max<lv_coord_t>(area.x1, 0);
+        area.y1 = std::max<lv_coord_t>(area.y1, 0);
+        area.x2 = std::min<lv_coord_t>(area.x2, dsc->header.w - 1);
+        area.y2 = std::min<lv_coord_t>(area.y2, dsc->header.h - 1);
+        return area.x1 <= area.x2 && area.y1 <= area.y2;
+    }
+
+#if LV_COLOR_DEPTH == 32
+    // rounded division by 255, exact for x <= 255 * 255
+    static inline uint32_t div255(uint32_t x) {
+        x += 128;
+        return (x + (x >> 8)) >> 8;
+    }
+
+    static inline uint32_t mix_channel(uint32_t s, uint32_t d, uint32_t a) {
+        return div255(s * a + d * (255 - a));
+    }
+
+#if defined(__SSE2__)
+    // same as div255, on 16-bit lanes
+    static inline __m128i div255_epu16(__m128i x) {
+        x = _mm_add_epi16(x, _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+    }
+
+    // (s * a + d * (255 - a)) / 255 on 16-bit lanes
+    static inline __m128i mix_epu16(__m128i s, __m128i d, __m128i a) {
+        auto x = _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a)));
+        return div255_epu16(x);
+    }
+
+    // broadcasts the alpha of the 2 pixels held in 16-bit lanes
+    static inline __m128i splat_alpha_epu16(__m128i px) {
+        px = _mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3));
+        return _mm_shufflehi_epi16(px, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+#endif
+
+    // blends src over an opaque dst row; alpha is src alpha (if src_alpha) times opa
+    static void blend_row_32(uint8_t * dst, const uint8_t * src, lv_coord_t len, lv_opa_t opa, bool src_alpha) {
+        lv_coord_t i = 0;
+#if defined(__SSE2__)
+        auto zero = _mm_setzero_si128();
+        auto opa16 = _mm_set1_epi16(opa);
+        auto alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        for (; i + 4 <= len; i += 4) {
+            auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4*i));
+            auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + 4*i));
+            auto s_lo = _mm_unpacklo_epi8(s, zero);
+            auto s_hi = _mm_unpackhi_epi8(s, zero);
+            auto a_lo = opa16, a_hi = opa16;
+            if (src_alpha) {
+                a_lo = div255_epu16(_mm_mullo_epi16(splat_alpha_epu16(s_lo), opa16));
+                a_hi = div255_epu16(_mm_mullo_epi16(splat_alpha_epu16(s_hi), opa16));
+            }
+            auto r_lo = mix_epu16(s_lo, _mm_unpacklo_epi8(d, zero), a_lo);
+            auto r_hi = mix_epu16(s_hi, _mm_unpackhi_epi8(d, zero), a_hi);
+            auto r = _mm_or_si128(_mm_packus_epi16(r_lo, r_hi), alpha_mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4*i), r);
+        }
+#endif
+        for (; i < len; i++) {
+            auto s = src + 4*i;
+            auto d = dst + 4*i;
+            uint32_t a = src_alpha ? div255(s[3] * opa) : opa;
+            for (int ch=0; ch<3; ch++)
+                d[ch] = static_cast<uint8_t>(mix_channel(s[ch], d[ch], a));
+            d[3] = 0xFF;
+        }
+    }
+
+    // multiplies colors by alpha, keeping alpha
+    static void premultiply_row_32(uint8_t * row, lv_coord_t len) {
+        lv_coord_t i = 0;
+#if defined(__SSE2__)
+        auto zero = _mm_setzero_si128();
+        auto alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        for (; i + 4 <= len; i += 4) {
+            auto p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4*i));
+            auto p_lo = _mm_unpacklo_epi8(p, zero);
+            auto p_hi = _mm_unpackhi_epi8(p, zero);
+            auto r_lo = div255_epu16(_mm_mullo_epi16(p_lo, splat_alpha_epu16(p_lo)));
+            auto r_hi = div255_epu16(_mm_mullo_epi16(p_hi, splat_alpha_epu16(p_hi)));
+            auto r = _mm_packus_epi16(r_lo, r_hi);
+            r = _mm_or_si128(_mm_andnot_si128(alpha_mask, r), _mm_and_si128(alpha_mask, p));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + 4*i), r);
+        }
+#endif
+        for (; i < len; i++) {
+            auto p = row + 4*i;
+            for (int ch=0; ch<3; ch++)
+                p[ch] = static_cast<uint8_t>(div255(p[ch] * p[3]));
+        }
+    }
+
+    // mixes a color into a row, keeping alpha
+    static void tint_row_32(uint8_t * row, lv_coord_t len, lv_color_t color, lv_opa_t mix) {
+        lv_coord_t i = 0;
+#if defined(__SSE2__)
+        auto zero = _mm_setzero_si128();
+        auto alpha_mask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+        auto c = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color.full)), zero);
+        auto mix16 = _mm_set1_epi16(mix);
+        for (; i + 4 <= len; i += 4) {
+            auto p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 4*i));
+            auto r_lo = mix_epu16(c, _mm_unpacklo_epi8(p, zero), mix16);
+            auto r_hi = mix_epu16(c, _mm_unpackhi_epi8(p, zero), mix16);
+            auto r = _mm_packus_epi16(r_lo, r_hi);
+            r = _mm_or_si128(_mm_andnot_si128(alpha_mask, r), _mm_and_si128(alpha_mask, p));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + 4*i), r);
+        }
+#endif
+        const uint8_t c8[3] = {color.ch.blue, color.ch.green, color.ch.red};
+        for (; i < len; i++) {
+            auto p = row + 4*i;
+            for (int ch=0; ch<3; ch++)
+                p[ch] = static_cast<uint8_t>(mix_channel(c8[ch], p[ch], mix));
+        }
+    }
+#endif // LV_COLOR_DEPTH == 32
     
     ImageDecoder::ImageDecoder(const ImageDescriptor & src, lv_color_t color, int32_t frame_id) {
         lv_img_decoder_open(this->raw_ptr(), src.raw_ptr(), color, frame_id);
@@ -49,14 +209,101 @@ namespace lvgl::draw {
     }
 
 
+    PixelBuffer::PixelBuffer(uint32_t size) {
+        auto p = static_cast<uint8_t*>(lv_mem_alloc(size));
+        if (p == nullptr) return;
+        std::memset(p, 0, size);
+        this->data = std::shared_ptr<uint8_t>(p, lv_mem_free);
+        this->size = size;
+    }
+
+    PixelBuffer::PixelBuffer(const uint8_t * data, uint32_t size) : PixelBuffer(size) {
+        if (this->data != nullptr && data != nullptr)
+            std::memcpy(this->data.get(), data, size);
+    }
+
+    PixelBuffer::PixelBuffer(std::vector<uint8_t> && data) {
+        // the vector lives in the control block; the pointer aliases its content
+        auto v = std::make_shared<std::vector<uint8_t>>(std::move(data));
+        this->data = std::shared_ptr<uint8_t>(v, v->data());
+        this->size = static_cast<uint32_t>(v->size());
+    }
+
+    uint8_t * PixelBuffer::get_data() {
+        return this->data.get();
+    }
+
+    const uint8_t * PixelBuffer::get_data() const {
+        return this->data.get();
+    }
+
+    uint32_t PixelBuffer::get_size() const {
+        return this->size;
+    }
+
+    long PixelBuffer::get_use_count() const {
+        return this->data.use_count();
+    }
+
+    bool PixelBuffer::is_empty() const {
+        return this->data == nullptr;
+    }
+
+
     ImageDescriptor::ImageDescriptor() {
         this->lv_obj = LvPointer<lv_img_dsc_t, lv_img_buf_free>(lv_cls_alloc<lv_img_dsc_t>());
+        if (this->raw_ptr() != nullptr)
+            std::memset(this->raw_ptr(), 0, sizeof(lv_img_dsc_t));
     }
 
     ImageDescriptor::ImageDescriptor(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf) {
         this->lv_obj = LvPointer<lv_img_dsc_t, lv_img_buf_free>(lv_img_buf_alloc(w, h, cf));
     }
 
+    ImageDescriptor::ImageDescriptor(const PixelBuffer & buffer, uint32_t w, uint32_t h, lv_img_cf_t cf) : ImageDescriptor() {
+        this->set_src(buffer, w, h, cf);
+    }
+
+    ImageDescriptor::ImageDescriptor(ImageDescriptor && obj)
+        : PointerWrapper(std::move(obj)), buffer(std::move(obj.buffer)), owns_data(obj.owns_data) {}
+
+    ImageDescriptor & ImageDescriptor::operator=(ImageDescriptor && obj) {
+        if (this != &obj) {
+            this->detach_data();
+            PointerWrapper::operator=(std::move(obj));
+            this->buffer = std::move(obj.buffer);
+            this->owns_data = obj.owns_data;
+        }
+        return *this;
+    }
+
+    ImageDescriptor::~ImageDescriptor() {
+        this->detach_data();
+    }
+
+    void ImageDescriptor::release_data() {
+        auto dsc = this->raw_ptr();
+        if (dsc != nullptr && dsc->data != nullptr) {
+            // LVGL's image cache is keyed by descriptor and may still hold
+            // the data about to be freed or replaced
+            lv_img_cache_invalidate_src(dsc);
+            if (this->owns_ptr && this->owns_data) {
+                lv_mem_free(const_cast<uint8_t*>(dsc->data));
+                dsc->data = nullptr;
+            }
+        }
+        this->buffer = PixelBuffer();
+    }
+
+    void ImageDescriptor::detach_data() {
+        // descriptors that aren't owned are released, not freed
+        if (!this->owns_ptr || this->raw_ptr() == nullptr) return;
+        // LVGL's image cache is keyed by descriptor address, which may be reused
+        lv_img_cache_invalidate_src(this->raw_ptr());
+        if (!this->owns_data)
+            this->raw_ptr()->data = nullptr;
+    }
+
     lv_color_t ImageDescriptor::get_px_color(lv_coord_t x, lv_coord_t y, lv_color_t bg_color) const {
         return lv_img_buf_get_px_color(const_cast<lv_cls_ptr>(this->raw_ptr()), x, y, bg_color);
     }
@@ -82,6 +329,8 @@ namespace lvgl::draw {
     }
 
     void ImageDescriptor::set_src(const std::vector<uint8_t> & src, uint32_t w, uint32_t h, lv_img_cf_t cf) {
+        this->release_data();
+        this->owns_data = false;
         this->raw_ptr()->data = src.data();
         this->raw_ptr()->data_size = src.size();
         this->raw_ptr()->header.w = w;
@@ -89,12 +338,262 @@ namespace lvgl::draw {
         this->raw_ptr()->header.cf = cf;
     }
 
+    void ImageDescriptor::set_src(std::vector<uint8_t> && src, uint32_t w, uint32_t h, lv_img_cf_t cf) {
+        this->set_src(PixelBuffer(std::move(src)), w, h, cf);
+    }
+
     void ImageDescriptor::set_src(const uint8_t * src, uint32_t w, uint32_t h, lv_img_cf_t cf) {
+        this->release_data();
+        this->owns_data = false;
         this->raw_ptr()->data = src;
         this->raw_ptr()->data_size = lv_img_buf_get_img_size(w, h, cf);
         this->raw_ptr()->header.w = w;
         this->raw_ptr()->header.h = h;
         this->raw_ptr()->header.cf = cf;
     }
-    
-}
\ No newline at end of file
+
+    void ImageDescriptor::set_src(const PixelBuffer & src, uint32_t w, uint32_t h, lv_img_cf_t cf) {
+        // src may be this descriptor's own buffer
+        auto buffer = src;
+        this->release_data();
+        this->owns_data = false;
+        this->buffer = std::move(buffer);
+        this->raw_ptr()->data = this->buffer.get_data();
+        this->raw_ptr()->data_size = this->buffer.get_size();
+        this->raw_ptr()->header.w = w;
+        this->raw_ptr()->header.h = h;
+        this->raw_ptr()->header.cf = cf;
+    }
+
+    PixelBuffer ImageDescriptor::get_buffer() {
+        auto dsc = this->raw_ptr();
+        if (this->buffer.is_empty() && this->owns_ptr && this->owns_data && dsc != nullptr && dsc->data != nullptr) {
+            // hand owned data over: it was allocated with lv_mem_alloc by lv_img_buf_alloc
+            this->buffer.data = std::shared_ptr<uint8_t>(const_cast<uint8_t*>(dsc->data), lv_mem_free);
+            this->buffer.size = dsc->data_size;
+            this->owns_data = false;
+        }
+        return this->buffer;
+    }
+
+    PixelBuffer ImageDescriptor::get_buffer() const {
+        return this->buffer;
+    }
+
+    ImageDescriptor ImageDescriptor::share() {
+        ImageDescriptor result;
+        auto dsc = this->raw_ptr();
+        auto res = result.raw_ptr();
+        if (dsc == nullptr || res == nullptr) return result;
+        result.buffer = this->get_buffer();
+        result.owns_data = false;
+        res->header = dsc->header;
+        res->data = dsc->data;
+        res->data_size = dsc->data_size;
+        return result;
+    }
+
+    uint32_t ImageDescriptor::get_stride() const {
+        auto dsc = this->raw_ptr();
+        uint32_t bits = lv_img_cf_get_px_size(dsc->header.cf);
+        return (dsc->header.w * bits + 7) / 8;
+    }
+
+    const uint8_t * ImageDescriptor::get_row(lv_coord_t y) const {
+        auto dsc = this->raw_ptr();
+        auto stride = this->get_stride();
+        if (dsc->data == nullptr || stride == 0 || y < 0 || y >= static_cast<lv_coord_t>(dsc->header.h))
+            return nullptr;
+        // indexed formats start with a palette of 32-bit colors
+        uint32_t offset = 0;
+        switch (dsc->header.cf) {
+            case LV_IMG_CF_INDEXED_1BIT:
+            case LV_IMG_CF_INDEXED_2BIT:
+            case LV_IMG_CF_INDEXED_4BIT:
+            case LV_IMG_CF_INDEXED_8BIT:
+                offset = (1 << lv_img_cf_get_px_size(dsc->header.cf)) * sizeof(lv_color32_t);
+                break;
+            default:
+                break;
+        }
+        return dsc->data + offset + y * stride;
+    }
+
+    uint8_t * ImageDescriptor::get_row(lv_coord_t y) {
+        return const_cast<uint8_t*>(static_cast<const ImageDescriptor*>(this)->get_row(y));
+    }
+
+    void ImageDescriptor::fill_rect(const lv_area_t & area, lv_color_t color, lv_opa_t opa) {
+        auto dsc = this->raw_ptr();
+        lv_area_t a = area;
+        if (dsc->data == nullptr || !clip_area(a, dsc)) return;
+        auto cf = static_cast<lv_img_cf_t>(dsc->header.cf);
+        lv_coord_t w = a.x2 - a.x1 + 1;
+        auto px_size = get_true_color_size(cf);
+        if (px_size > 0) {
+            // fill first row, then copy it to the others
+            auto first = this->get_row(a.y1) + a.x1 * px_size;
+            store_color(first, color);
+            if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA)
+                first[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = opa;
+            for (lv_coord_t n=1; n<w; n*=2)
+                std::memcpy(first + n * px_size, first, std::min<lv_coord_t>(n, w - n) * px_size);
+            for (lv_coord_t y=a.y1+1; y<=a.y2; y++)
+                std::memcpy(this->get_row(y) + a.x1 * px_size, first, w * px_size);
+        } else if (cf == LV_IMG_CF_ALPHA_8BIT) {
+            for (lv_coord_t y=a.y1; y<=a.y2; y++)
+                std::memset(this->get_row(y) + a.x1, opa, w);
+        } else {
+            // packed formats: indexed ones take the index from color.full
+            bool alpha_only = cf >= LV_IMG_CF_ALPHA_1BIT && cf <= LV_IMG_CF_ALPHA_4BIT;
+            for (lv_coord_t y=a.y1; y<=a.y2; y++) {
+                for (lv_coord_t x=a.x1; x<=a.x2; x++) {
+                    if (alpha_only)
+                        lv_img_buf_set_px_alpha(dsc, x, y, opa);
+                    else
+                        lv_img_buf_set_px_color(dsc, x, y, color);
+                }
+            }
+        }
+    }
+
+    void ImageDescriptor::blit(const ImageDescriptor & src, lv_coord_t x, lv_coord_t y, lv_opa_t opa) {
+        auto dsc = this->raw_ptr();
+        auto src_dsc = src.raw_ptr();
+        auto cf = static_cast<lv_img_cf_t>(dsc->header.cf);
+        auto src_cf = static_cast<lv_img_cf_t>(src_dsc->header.cf);
+        auto px_size = get_true_color_size(cf);
+        auto src_px_size = get_true_color_size(src_cf);
+        if (opa <= LV_OPA_MIN || px_size == 0 || src_px_size == 0
+            || dsc->data == nullptr || src_dsc->data == nullptr) return;
+        lv_area_t a = {x, y, static_cast<lv_coord_t>(x + src_dsc->header.w - 1), static_cast<lv_coord_t>(y + src_dsc->header.h - 1)};
+        if (!clip_area(a, dsc)) return;
+        lv_coord_t w = a.x2 - a.x1 + 1;
+        for (lv_coord_t row=a.y1; row<=a.y2; row++) {
+            auto d = this->get_row(row) + a.x1 * px_size;
+            auto s = src.get_row(row - y) + (a.x1 - x) * src_px_size;
+            if (opa >= LV_OPA_MAX && src_cf == LV_IMG_CF_TRUE_COLOR && cf != LV_IMG_CF_TRUE_COLOR_ALPHA) {
+                std::memcpy(d, s, w * px_size);
+                continue;
+            }
+#if LV_COLOR_DEPTH == 32
+            if (src_cf != LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED && cf != LV_IMG_CF_TRUE_COLOR_ALPHA) {
+                blend_row_32(d, s, w, opa, src_cf == LV_IMG_CF_TRUE_COLOR_ALPHA);
+                continue;
+            }
+#endif
+            for (lv_coord_t n=0; n<w; n++, d+=px_size, s+=src_px_size) {
+                uint32_t sa = load_alpha(s, src_cf);
+                if (opa < LV_OPA_MAX) sa = sa * opa / 255;
+                if (sa <= LV_OPA_MIN) continue;
+                auto c = load_color(s);
+                if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) {
+                    // source-over: out = a + da * (1 - a), color weighted accordingly
+                    uint32_t da = d[LV_IMG_PX_SIZE_ALPHA_BYTE - 1];
+                    uint32_t out = sa + da * (255 - sa) / 255;
+                    store_color(d, lv_color_mix(c, load_color(d), static_cast<lv_opa_t>(sa * 255 / out)));
+                    d[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = static_cast<uint8_t>(out);
+                } else {
+                    store_color(d, sa >= LV_OPA_MAX ? c : lv_color_mix(c, load_color(d), static_cast<lv_opa_t>(sa)));
+                }
+            }
+        }
+    }
+
+    void ImageDescriptor::premultiply() {
+        auto dsc = this->raw_ptr();
+        if (dsc->data == nullptr || dsc->header.cf != LV_IMG_CF_TRUE_COLOR_ALPHA) return;
+        lv_coord_t w = dsc->header.w;
+        for (lv_coord_t y=0; y<static_cast<lv_coord_t>(dsc->header.h); y++) {
+            auto row = this->get_row(y);
+#if LV_COLOR_DEPTH == 32
+            premultiply_row_32(row, w);
+#else
+            for (lv_coord_t n=0; n<w; n++, row+=LV_IMG_PX_SIZE_ALPHA_BYTE) {
+                auto a = row[LV_IMG_PX_SIZE_ALPHA_BYTE - 1];
+                if (a < LV_OPA_MAX) store_color(row, lv_color_mix(load_color(row), lv_color_black(), a));
+            }
+#endif
+        }
+    }
+
+    void ImageDescriptor::tint(lv_color_t color, lv_opa_t mix) {
+        auto dsc = this->raw_ptr();
+        auto cf = static_cast<lv_img_cf_t>(dsc->header.cf);
+        auto px_size = get_true_color_size(cf);
+        if (dsc->data == nullptr || px_size == 0 || mix <= LV_OPA_MIN) return;
+        lv_coord_t w = dsc->header.w;
+        for (lv_coord_t y=0; y<static_cast<lv_coord_t>(dsc->header.h); y++) {
+            auto row = this->get_row(y);
+#if LV_COLOR_DEPTH == 32
+            // chroma-keyed pixels must stay keyed
+            if (cf != LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) {
+                tint_row_32(row, w, color, mix);
+                continue;
+            }
+#endif
+            for (lv_coord_t n=0; n<w; n++, row+=px_size) {
+                auto c = load_color(row);
+                if (cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED && c.full == LV_COLOR_CHROMA_KEY.full) continue;
+                // keep alpha byte of 32-bit colors
+                auto alpha = row[px_size - 1];
+                store_color(row, lv_color_mix(color, c, mix));
+                if (LV_COLOR_DEPTH == 32) row[px_size - 1] = alpha;
+            }
+        }
+    }
+
+    ImageDescriptor ImageDescriptor::convert_to(lv_img_cf_t cf, lv_color_t color) const {
+        auto dsc = this->raw_ptr();
+        auto src_cf = static_cast<lv_img_cf_t>(dsc->header.cf);
+        auto px_size = get_true_color_size(cf);
+        auto src_px_size = get_true_color_size(src_cf);
+        if (dsc->data == nullptr || (px_size == 0 && cf != LV_IMG_CF_ALPHA_8BIT))
+            return ImageDescriptor();
+        lv_coord_t w = dsc->header.w;
+        lv_coord_t h = dsc->header.h;
+        ImageDescriptor result(w, h, cf);
+        auto res = result.raw_ptr();
+        if (res == nullptr || res->data == nullptr) return ImageDescriptor();
+        if (cf == src_cf) {
+            std::memcpy(const_cast<uint8_t*>(res->data), dsc->data, std::min(res->data_size, dsc->data_size));
+            return result;
+        }
+        for (lv_coord_t y=0; y<h; y++) {
+            auto d = result.get_row(y);
+            auto s = this->get_row(y);
+            if (src_px_size > 0 && px_size > 0) {
+                // true color to true color: alpha is dropped or converted to chroma key
+                for (lv_coord_t n=0; n<w; n++, d+=px_size, s+=src_px_size) {
+                    auto a = load_alpha(s, src_cf);
+                    store_color(d, (cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED && a < LV_OPA_50) ? LV_COLOR_CHROMA_KEY : load_color(s));
+                    if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) d[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = a;
+                }
+            } else if (src_px_size > 0) {
+                // true color to alpha
+                for (lv_coord_t n=0; n<w; n++, s+=src_px_size)
+                    d[n] = load_alpha(s, src_cf);
+            } else if (src_cf == LV_IMG_CF_ALPHA_8BIT && cf == LV_IMG_CF_TRUE_COLOR_ALPHA) {
+                for (lv_coord_t n=0; n<w; n++, d+=px_size) {
+                    store_color(d, color);
+                    d[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = s[n];
+                }
+            } else {
+                // other formats: go through LVGL pixel accessors
+                for (lv_coord_t x=0; x<w; x++) {
+                    auto a = this->get_px_alpha(x, y);
+                    if (px_size == 0) {
+                        d[x] = a;
+                        continue;
+                    }
+                    auto c = this->get_px_color(x, y, color);
+                    if (cf == LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED && a < LV_OPA_50) c = LV_COLOR_CHROMA_KEY;
+                    store_color(d + x * px_size, c);
+                    if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) d[x * px_size + LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = a;
+                }
+            }
+        }
+        return result;
+    }
+
+}
@@ -9,6 +9,7 @@
 #include "../misc/color.h"
 #include "../misc/area.h"
 #include "../lv_wrapper.h"
+#include <memory>
 #include <vector>
 
 namespace lvgl::draw {
@@ -153,15 +154,136 @@ namespace lvgl::draw {
     };
 
 
+    /** \class PixelBuffer
+     *  \brief Reference-counted pixel data. Copies share the same memory,
+     *  which is freed when the last copy goes away. Image descriptors
+     *  holding a buffer keep it alive.
+     */
+    class PixelBuffer {
+    private:
+        /** \property std::shared_ptr<uint8_t> data
+         *  \brief Shared data.
+         */
+        std::shared_ptr<uint8_t> data;
+
+        /** \property uint32_t size
+         *  \brief Data size, in bytes.
+         */
+        uint32_t size = 0;
+
+        friend class ImageDescriptor;
+
+    public:
+        /** \fn PixelBuffer()
+         *  \brief Default constructor. Creates an empty buffer.
+         */
+        PixelBuffer() = default;
+
+        /** \fn PixelBuffer(uint32_t size)
+         *  \brief Constructor allocating a zero-filled buffer with LVGL mem_alloc.
+         *  \param size: buffer size, in bytes.
+         */
+        explicit PixelBuffer(uint32_t size);
+
+        /** \fn PixelBuffer(const uint8_t * data, uint32_t size)
+         *  \brief Constructor copying data.
+         *  \param data: data to copy.
+         *  \param size: data size, in bytes.
+         */
+        PixelBuffer(const uint8_t * data, uint32_t size);
+
+        /** \fn PixelBuffer(std::vector<uint8_t> && data)
+         *  \brief Constructor taking over a vector, without copy.
+         *  \param data: vector to take over.
+         */
+        PixelBuffer(std::vector<uint8_t> && data);
+
+        /** \fn uint8_t * get_data()
+         *  \brief Gets pointer to data.
+         *  \returns pointer to data, or nullptr if buffer is empty.
+         */
+        uint8_t * get_data();
+
+        /** \fn const uint8_t * get_data() const
+         *  \brief Gets pointer to data (const version).
+         *  \returns pointer to data, or nullptr if buffer is empty.
+         */
+        const uint8_t * get_data() const;
+
+        /** \fn uint32_t get_size() const
+         *  \brief Gets data size.
+         *  \returns data size, in bytes.
+         */
+        uint32_t get_size() const;
+
+        /** \fn long get_use_count() const
+         *  \brief Gets the number of buffers and descriptors sharing data.
+         *  \returns use count; 0 if buffer is empty.
+         */
+        long get_use_count() const;
+
+        /** \fn bool is_empty() const
+         *  \brief Tells if buffer holds no data.
+         *  \returns true if buffer is empty, false otherwise.
+         */
+        bool is_empty() const;
+    };
+
+
     /** \class ImageDescriptor
-     *  \brief Wraps a lv_img_dsc_t object.
+     *  \brief Wraps a lv_img_dsc_t object. Pixel data can be owned (allocated
+     *  by LVGL with the descriptor), shared (held through a PixelBuffer) or
+     *  external (set from a raw pointer or a vector reference, which must
+     *  outlive the descriptor). Only owned data is freed with the descriptor.
      */
     class ImageDescriptor : public PointerWrapper<lv_img_dsc_t, lv_img_buf_free> {
+    private:
+        /** \property PixelBuffer buffer
+         *  \brief Shared pixel data, if any.
+         */
+        PixelBuffer buffer;
+
+        /** \property bool owns_data
+         *  \brief If true, pixel data is freed with the descriptor.
+         */
+        bool owns_data = true;
+
+        /** \fn void release_data()
+         *  \brief Frees owned pixel data and drops shared data, removing
+         *  the descriptor from LVGL's image cache.
+         */
+        void release_data();
+
+        /** \fn void detach_data()
+         *  \brief Prepares an owned descriptor for lv_img_buf_free: removes it
+         *  from LVGL's image cache and unlinks pixel data that isn't owned, so
+         *  that it doesn't get freed.
+         */
+        void detach_data();
+
     public:
         using PointerWrapper::PointerWrapper;
 
         ImageDescriptor();
 
+        /** \fn ImageDescriptor(ImageDescriptor && obj)
+         *  \brief Move constructor.
+         *  \param obj: object to move.
+         */
+        ImageDescriptor(ImageDescriptor && obj);
+
+        /** \fn ImageDescriptor & operator=(ImageDescriptor && obj)
+         *  \brief Move assignment operator.
+         *  \param obj: object to move.
+         *  \returns reference to this object.
+         */
+        ImageDescriptor & operator=(ImageDescriptor && obj);
+
+        /** \fn ~ImageDescriptor()
+         *  \brief Destructor. Frees pixel data only if owned.
+         */
+        ~ImageDescriptor();
+
         /** \fn ImageDescriptor(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf)
          *  \brief Constructor with parameters.
          *  \param w: buffer width.
@@ -170,6 +292,15 @@ namespace lvgl::draw {
          */
         ImageDescriptor(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf);
 
+        /** \fn ImageDescriptor(const PixelBuffer & buffer, uint32_t w, uint32_t h, lv_img_cf_t cf)
+         *  \brief Constructor with shared pixel data.
+         *  \param buffer: pixel data.
+         *  \param w: image width.
+         *  \param h: image height.
+         *  \param cf: color format.
+         */
+        ImageDescriptor(const PixelBuffer & buffer, uint32_t w, uint32_t h, lv_img_cf_t cf);
+
         /** \fn lv_color_t get_px_color(lv_coord_t x, lv_coord_t y, lv_color_t bg_color) const
          *  \brief Gets pixel color.
          *  \param x: horizontal coordinate.
@@ -220,7 +351,7 @@ namespace lvgl::draw {
         uint32_t get_img_size(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf) const;
 
         /** \fn void set_src(const std::vector<uint8_t> & src, uint32_t w, uint32_t h, lv_img_cf_t cf)
-         *  \brief Sets image source.
+         *  \brief Sets image source, without copy. Source must outlive descriptor.
          *  \param src: source buffer.
          *  \param w: image width.
          *  \param h: image height.
@@ -228,8 +359,17 @@ namespace lvgl::draw {
          */
         void set_src(const std::vector<uint8_t> & src, uint32_t w, uint32_t h, lv_img_cf_t cf);
 
+        /** \fn void set_src(std::vector<uint8_t> && src, uint32_t w, uint32_t h, lv_img_cf_t cf)
+         *  \brief Sets image source, taking over vector without copy.
+         *  \param src: source buffer.
+         *  \param w: image width.
+         *  \param h: image height.
+         *  \param cf: color format.
+         */
+        void set_src(std::vector<uint8_t> && src, uint32_t w, uint32_t h, lv_img_cf_t cf);
+
         /** \fn void set_src(const uint8_t * src, uint32_t w, uint32_t h, lv_img_cf_t cf)
-         *  \brief Sets image source.
+         *  \brief Sets image source, without copy. Source must outlive descriptor.
          *  \param src: pointer to source buffer.
          *  \param w: image width.
          *  \param h: image height.
@@ -237,6 +377,105 @@ namespace lvgl::draw {
          */
         void set_src(const uint8_t * src, uint32_t w, uint32_t h, lv_img_cf_t cf);
 
+        /** \fn void set_src(const PixelBuffer & src, uint32_t w, uint32_t h, lv_img_cf_t cf)
+         *  \brief Sets image source, sharing pixel data.
+         *  \param src: pixel data.
+         *  \param w: image width.
+         *  \param h: image height.
+         *  \param cf: color format.
+         */
+        void set_src(const PixelBuffer & src, uint32_t w, uint32_t h, lv_img_cf_t cf);
+
+        /** \fn PixelBuffer get_buffer()
+         *  \brief Gets pixel data as a shared buffer. Owned data is handed
+         *  over to the buffer without copy.
+         *  \returns shared pixel data; empty if data is external or missing.
+         */
+        PixelBuffer get_buffer();
+
+        /** \fn PixelBuffer get_buffer() const
+         *  \brief Gets shared pixel data (const version). Owned data isn't
+         *  handed over.
+         *  \returns shared pixel data; empty if data is owned, external or
+         *  missing.
+         */
+        PixelBuffer get_buffer() const;
+
+        /** \fn ImageDescriptor share()
+         *  \brief Creates a descriptor referencing the same pixels. Owned data
+         *  is first handed over to a shared buffer, so that both descriptors
+         *  keep it alive. External data stays external.
+         *  \returns new descriptor.
+         */
+        ImageDescriptor share();
+
+        /** \fn uint32_t get_stride() const
+         *  \brief Gets the number of bytes per row.
+         *  \returns number of bytes per row, or 0 if format isn't supported.
+         */
+        uint32_t get_stride() const;
+
+        /** \fn uint8_t * get_row(lv_coord_t y)
+         *  \brief Gets pointer to the pixels of a row, after palette if any.
+         *  \param y: vertical coordinate.
+         *  \returns pointer to row, or nullptr if out of bounds or format
+         *  isn't supported.
+         */
+        uint8_t * get_row(lv_coord_t y);
+
+        /** \fn const uint8_t * get_row(lv_coord_t y) const
+         *  \brief Gets pointer to the pixels of a row, after palette if any.
+         *  \param y: vertical coordinate.
+         *  \returns pointer to row, or nullptr if out of bounds or format
+         *  isn't supported.
+         */
+        const uint8_t * get_row(lv_coord_t y) const;
+
+        /** \fn void fill_rect(const lv_area_t & area, lv_color_t color, lv_opa_t opa = LV_OPA_COVER)
+         *  \brief Fills an area, replacing pixels. For true color formats,
+         *  opa sets the alpha of formats that have one; for LV_IMG_CF_ALPHA_8BIT,
+         *  color is ignored and opa is written.
+         *  \param area: area to fill, clipped to image.
+         *  \param color: fill color.
+         *  \param opa: fill opacity.
+         */
+        void fill_rect(const lv_area_t & area, lv_color_t color, lv_opa_t opa = LV_OPA_COVER);
+
+        /** \fn void blit(const ImageDescriptor & src, lv_coord_t x, lv_coord_t y, lv_opa_t opa = LV_OPA_COVER)
+         *  \brief Draws an image over this one, blending by its alpha (or
+         *  skipping its chroma-keyed pixels) and by opa. Both images must
+         *  be in a true color format. Destination alpha, if any, is
+         *  combined as in source-over compositing.
+         *  \param src: image to draw.
+         *  \param x: horizontal position of source in this image.
+         *  \param y: vertical position of source in this image.
+         *  \param opa: overall opacity.
+         */
+        void blit(const ImageDescriptor & src, lv_coord_t x, lv_coord_t y, lv_opa_t opa = LV_OPA_COVER);
+
+        /** \fn void premultiply()
+         *  \brief Multiplies colors by alpha (LV_IMG_CF_TRUE_COLOR_ALPHA only).
+         */
+        void premultiply();
+
+        /** \fn void tint(lv_color_t color, lv_opa_t mix)
+         *  \brief Mixes every pixel with a color, keeping alpha (true color
+         *  formats only).
+         *  \param color: tint color.
+         *  \param mix: tint strength (LV_OPA_TRANSP: none, LV_OPA_COVER: full).
+         */
+        void tint(lv_color_t color, lv_opa_t mix);
+
+        /** \fn ImageDescriptor convert_to(lv_img_cf_t cf, lv_color_t color = lv_color_black()) const
+         *  \brief Copies image in another format. Conversions between true
+         *  color formats and LV_IMG_CF_ALPHA_8BIT are done row by row; other
+         *  sources are converted pixel by pixel to a true color format.
+         *  \param cf: target color format.
+         *  \param color: color of pixels converted from an alpha-only format.
+         *  \returns converted image; without data if conversion isn't supported.
+         */
+        ImageDescriptor convert_to(lv_img_cf_t cf, lv_color_t color = lv_color_black()) const;
+
     };
 
 }
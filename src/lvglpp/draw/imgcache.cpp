@@ -0,0 +1,193 @@
+/** \file imgcache.cpp
+ *  \brief Implementation file for a byte-budgeted cache of decoded images.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <cstring>
+#include "imgcache.h"
+
+namespace lvgl::draw {
+
+    ImageCache::ImageCache(size_t budget) : budget(budget) {}
+
+    std::string ImageCache::make_key(const ImageDescriptor & src) {
+        // paths start with a drive letter, so this can't collide
+        auto p = src.raw_ptr();
+        std::string key(1 + sizeof(p), '\x01');
+        std::memcpy(&key[1], &p, sizeof(p));
+        return key;
+    }
+
+    void ImageCache::release(const ImageDescriptor * image) {
+        // LVGL's own cache may still point to the decoded data
+        lv_img_cache_invalidate_src(image->raw_ptr());
+        delete image;
+    }
+
+    ImageCache::Handle ImageCache::decode(const void * src) {
+        lv_img_decoder_dsc_t dsc;
+        if (lv_img_decoder_open(&dsc, src, lv_color_black(), 0) != LV_RES_OK)
+            return nullptr;
+        auto header = dsc.header;
+        if (header.w == 0 || header.h == 0) {
+            lv_img_decoder_close(&dsc);
+            return nullptr;
+        }
+        lv_img_cf_t cf = lv_img_cf_has_alpha(header.cf) ? LV_IMG_CF_TRUE_COLOR_ALPHA
+                       : lv_img_cf_is_chroma_keyed(header.cf) ? LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED
+                       : LV_IMG_CF_TRUE_COLOR;
+        auto image = new ImageDescriptor(static_cast<lv_coord_t>(header.w), static_cast<lv_coord_t>(header.h), cf);
+        Handle handle(image, release);
+        auto dst = const_cast<uint8_t*>(image->raw_ptr()->data);
+        if (dst == nullptr) {
+            lv_img_decoder_close(&dsc);
+            return nullptr;
+        }
+        uint32_t size = image->raw_ptr()->data_size;
+        bool ok = true;
+        if (dsc.img_data != nullptr) {
+            // decoder provides the whole image in true color format
+            std::memcpy(dst, dsc.img_data, size);
+        } else {
+            uint32_t line_size = size / header.h;
+            for (lv_coord_t y=0; y<header.h && ok; y++)
+                ok = lv_img_decoder_read_line(&dsc, 0, y, header.w, dst + y * line_size) == LV_RES_OK;
+        }
+        lv_img_decoder_close(&dsc);
+        return ok ? handle : nullptr;
+    }
+
+    ImageCache::Handle ImageCache::get(const std::string & key, const void * src) {
+        auto it = this->entries.find(key);
+        if (it != this->entries.end()) {
+            it->second.stamp = ++this->stamp;
+            it->second.uses++;
+            this->stats.hits++;
+            return it->second.image;
+        }
+        this->stats.misses++;
+        auto image = decode(src);
+        if (image == nullptr) return nullptr;
+        size_t size = image->raw_ptr()->data_size;
+        // too large: served without caching
+        if (size > this->budget) return image;
+        this->make_room(size);
+        this->entries.emplace(key, Entry{image, size, ++this->stamp, 1, 0});
+        this->stats.bytes_used += size;
+        this->stats.entries++;
+        return image;
+    }
+
+    void ImageCache::make_room(size_t size) {
+        while (this->stats.bytes_used + size > this->budget) {
+            // least recently used among images used once, then among others
+            auto victim = this->entries.end();
+            for (auto it = this->entries.begin(); it != this->entries.end(); it++) {
+                auto & e = it->second;
+                if (e.pins > 0 || e.image.use_count() > 1) continue;
+                if (victim == this->entries.end()) {
+                    victim = it;
+                    continue;
+                }
+                bool once = e.uses < 2;
+                bool victim_once = victim->second.uses < 2;
+                if (once > victim_once || (once == victim_once && e.stamp < victim->second.stamp))
+                    victim = it;
+            }
+            if (victim == this->entries.end()) break;
+            this->erase(victim);
+            this->stats.evictions++;
+        }
+    }
+
+    void ImageCache::erase(std::unordered_map<std::string, Entry>::iterator it) {
+        this->stats.bytes_used -= it->second.size;
+        this->stats.entries--;
+        this->entries.erase(it);
+    }
+
+    void ImageCache::delete_cb(lv_event_t * e) {
+        delete static_cast<Handle*>(lv_event_get_user_data(e));
+    }
+
+    ImageCache::Handle ImageCache::get(const std::string & src) {
+        return this->get(src, src.c_str());
+    }
+
+    ImageCache::Handle ImageCache::get(const ImageDescriptor & src) {
+        return this->get(make_key(src), src.raw_ptr());
+    }
+
+    ImageCache::Handle ImageCache::pin(const std::string & src) {
+        auto image = this->get(src);
+        auto it = this->entries.find(src);
+        if (it != this->entries.end()) it->second.pins++;
+        return image;
+    }
+
+    ImageCache::Handle ImageCache::pin(const ImageDescriptor & src) {
+        auto image = this->get(src);
+        auto it = this->entries.find(make_key(src));
+        if (it != this->entries.end()) it->second.pins++;
+        return image;
+    }
+
+    void ImageCache::unpin(const std::string & src) {
+        auto it = this->entries.find(src);
+        if (it != this->entries.end() && it->second.pins > 0) it->second.pins--;
+    }
+
+    void ImageCache::unpin(const ImageDescriptor & src) {
+        auto it = this->entries.find(make_key(src));
+        if (it != this->entries.end() && it->second.pins > 0) it->second.pins--;
+    }
+
+    void ImageCache::unpin_all() {
+        for (auto & e : this->entries)
+            e.second.pins = 0;
+    }
+
+    void ImageCache::attach(lv_obj_t * obj, const Handle & image) {
+        auto held = static_cast<Handle*>(lv_obj_get_event_user_data(obj, delete_cb));
+        if (held != nullptr) {
+            *held = image;
+        } else {
+            lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, static_cast<void*>(new Handle(image)));
+        }
+    }
+
+    void ImageCache::detach(lv_obj_t * obj) {
+        auto held = static_cast<Handle*>(lv_obj_get_event_user_data(obj, delete_cb));
+        if (held == nullptr) return;
+        lv_obj_remove_event_cb_with_user_data(obj, delete_cb, held);
+        delete held;
+    }
+
+    void ImageCache::set_budget(size_t budget) {
+        this->budget = budget;
+        this->make_room(0);
+    }
+
+    void ImageCache::trim() {
+        for (auto it = this->entries.begin(); it != this->entries.end();) {
+            auto next = std::next(it);
+            if (it->second.pins == 0 && it->second.image.use_count() == 1) {
+                this->erase(it);
+                this->stats.evictions++;
+            }
+            it = next;
+        }
+    }
+
+    const ImageCache::Stats & ImageCache::get_stats() const {
+        return this->stats;
+    }
+
+    void ImageCache::reset_stats() {
+        this->stats.hits = 0;
+        this->stats.misses = 0;
+        this->stats.evictions = 0;
+    }
+
+}
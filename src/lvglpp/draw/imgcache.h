@@ -0,0 +1,261 @@
+/** \file imgcache.h
+ *  \brief Header file for a byte-budgeted cache of decoded images.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "image.h"
+
+namespace lvgl::draw {
+
+    /** \class ImageCache
+     *  \brief Keeps decoded copies of images (files, symbols excluded, or
+     *  descriptors in formats that need decoding) within a byte budget.
+     *  Decoded images are true color descriptors drawn by LVGL without
+     *  further decoding. Images used at least twice are protected: when
+     *  room is needed, images used once are evicted first, each group in
+     *  least recently used order. Pinned images and images still
+     *  referenced outside the cache (handles, widgets set with
+     *  Image::set_src) are never evicted, so the budget may be exceeded
+     *  while they are in use. Images outlive the cache as long as they
+     *  are referenced.
+     */
+    class ImageCache {
+    public:
+        /** \typedef Handle
+         *  \brief Shared decoded image.
+         */
+        using Handle = std::shared_ptr<const ImageDescriptor>;
+
+        /** \struct Stats
+         *  \brief Cache statistics.
+         */
+        struct Stats {
+            /** \property uint32_t hits
+             *  \brief Number of requests served from cache.
+             */
+            uint32_t hits = 0;
+
+            /** \property uint32_t misses
+             *  \brief Number of requests that needed decoding.
+             */
+            uint32_t misses = 0;
+
+            /** \property uint32_t evictions
+             *  \brief Number of evicted images.
+             */
+            uint32_t evictions = 0;
+
+            /** \property size_t bytes_used
+             *  \brief Number of bytes held by cached images.
+             */
+            size_t bytes_used = 0;
+
+            /** \property uint32_t entries
+             *  \brief Number of cached images.
+             */
+            uint32_t entries = 0;
+        };
+
+    private:
+        /** \struct Entry
+         *  \brief Cached image.
+         */
+        struct Entry {
+            /** \property Handle image
+             *  \brief Decoded image.
+             */
+            Handle image;
+
+            /** \property size_t size
+             *  \brief Image size, in bytes.
+             */
+            size_t size;
+
+            /** \property uint64_t stamp
+             *  \brief Last use stamp.
+             */
+            uint64_t stamp;
+
+            /** \property uint32_t uses
+             *  \brief Number of requests.
+             */
+            uint32_t uses;
+
+            /** \property uint32_t pins
+             *  \brief Pin count.
+             */
+            uint32_t pins;
+        };
+
+        /** \property std::unordered_map<std::string, Entry> entries
+         *  \brief Cached images, by source key.
+         */
+        std::unordered_map<std::string, Entry> entries;
+
+        /** \property size_t budget
+         *  \brief Maximum number of bytes held by unused images.
+         */
+        size_t budget;
+
+        /** \property uint64_t stamp
+         *  \brief Use counter.
+         */
+        uint64_t stamp = 0;
+
+        /** \property Stats stats
+         *  \brief Cache statistics.
+         */
+        Stats stats;
+
+        /** \fn static std::string make_key(const ImageDescriptor & src)
+         *  \brief Makes cache key for an image descriptor.
+         *  \param src: image descriptor.
+         *  \returns key.
+         */
+        static std::string make_key(const ImageDescriptor & src);
+
+        /** \fn static void release(const ImageDescriptor * image)
+         *  \brief Deletes a decoded image once its last handle is dropped,
+         *  and removes it from LVGL's image cache.
+         *  \param image: decoded image.
+         */
+        static void release(const ImageDescriptor * image);
+
+        /** \fn static Handle decode(const void * src)
+         *  \brief Decodes an image with LVGL decoders.
+         *  \param src: image source (path or lv_img_dsc_t pointer).
+         *  \returns decoded image, or nullptr if failed.
+         */
+        static Handle decode(const void * src);
+
+        /** \fn Handle get(const std::string & key, const void * src)
+         *  \brief Gets an image from cache, decoding it if needed.
+         *  \param key: cache key.
+         *  \param src: image source.
+         *  \returns decoded image, or nullptr if failed.
+         */
+        Handle get(const std::string & key, const void * src);
+
+        /** \fn void make_room(size_t size)
+         *  \brief Evicts images until size more bytes fit in budget, or
+         *  nothing can be evicted.
+         *  \param size: number of bytes needed.
+         */
+        void make_room(size_t size);
+
+        /** \fn void erase(std::unordered_map<std::string, Entry>::iterator it)
+         *  \brief Removes an image from cache.
+         *  \param it: cache entry.
+         */
+        void erase(std::unordered_map<std::string, Entry>::iterator it);
+
+        /** \fn static void delete_cb(lv_event_t * e)
+         *  \brief Releases image of a deleted object. Event user data is
+         *  a heap-allocated handle owned by the object.
+         *  \param e: delete event.
+         */
+        static void delete_cb(lv_event_t * e);
+
+    public:
+        /** \fn ImageCache(size_t budget)
+         *  \brief Constructor.
+         *  \param budget: maximum number of bytes held by cached images.
+         */
+        ImageCache(size_t budget);
+
+        ImageCache(const ImageCache &) = delete;
+        ImageCache & operator=(const ImageCache &) = delete;
+
+        /** \fn Handle get(const std::string & src)
+         *  \brief Gets a decoded image.
+         *  \param src: image path.
+         *  \returns decoded image, or nullptr if failed.
+         */
+        Handle get(const std::string & src);
+
+        /** \fn Handle get(const ImageDescriptor & src)
+         *  \brief Gets a decoded copy of an image descriptor, e.g. in an
+         *  indexed or compressed format. Descriptor must not change while
+         *  cached.
+         *  \param src: image descriptor.
+         *  \returns decoded image, or nullptr if failed.
+         */
+        Handle get(const ImageDescriptor & src);
+
+        /** \fn Handle pin(const std::string & src)
+         *  \brief Gets a decoded image and protects it from eviction.
+         *  \param src: image path.
+         *  \returns decoded image, or nullptr if failed.
+         */
+        Handle pin(const std::string & src);
+
+        /** \fn Handle pin(const ImageDescriptor & src)
+         *  \brief Gets a decoded image and protects it from eviction.
+         *  \param src: image descriptor.
+         *  \returns decoded image, or nullptr if failed.
+         */
+        Handle pin(const ImageDescriptor & src);
+
+        /** \fn void unpin(const std::string & src)
+         *  \brief Removes one pin from an image.
+         *  \param src: image path.
+         */
+        void unpin(const std::string & src);
+
+        /** \fn void unpin(const ImageDescriptor & src)
+         *  \brief Removes one pin from an image.
+         *  \param src: image descriptor.
+         */
+        void unpin(const ImageDescriptor & src);
+
+        /** \fn void unpin_all()
+         *  \brief Removes all pins, e.g. when leaving a screen.
+         */
+        void unpin_all();
+
+        /** \fn static void attach(lv_obj_t * obj, const Handle & image)
+         *  \brief Keeps an image alive while an object displays it, until
+         *  the object is deleted, detached or attached to another image.
+         *  This doesn't depend on the cache instance, which may be
+         *  destroyed first.
+         *  \param obj: object displaying image.
+         *  \param image: decoded image.
+         */
+        static void attach(lv_obj_t * obj, const Handle & image);
+
+        /** \fn static void detach(lv_obj_t * obj)
+         *  \brief Releases image kept alive for an object, e.g. when the
+         *  object is set to another source.
+         *  \param obj: object displaying image.
+         */
+        static void detach(lv_obj_t * obj);
+
+        /** \fn void set_budget(size_t budget)
+         *  \brief Sets byte budget, evicting images if needed.
+         *  \param budget: maximum number of bytes held by cached images.
+         */
+        void set_budget(size_t budget);
+
+        /** \fn void trim()
+         *  \brief Evicts all images that aren't pinned or in use.
+         */
+        void trim();
+
+        /** \fn const Stats & get_stats() const
+         *  \brief Gets cache statistics.
+         *  \returns cache statistics.
+         */
+        const Stats & get_stats() const;
+
+        /** \fn void reset_stats()
+         *  \brief Resets hit, miss and eviction counters.
+         */
+        void reset_stats();
+    };
+
+}
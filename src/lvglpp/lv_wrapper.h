@@ -181,7 +181,10 @@ namespace lvgl {
          *  \param obj: object to move.
          */
         PointerWrapper & operator=(LvWrapperType && obj) {
-            this->lv_obj = std::swap(this->lv_obj, obj.lv_obj);
+            // a pointer that isn't owned must not be deleted on reassignment
+            if (!this->owns_ptr)
+                this->release_ptr();
+            this->lv_obj = std::move(obj.lv_obj);
             this->owns_ptr = obj.owns_ptr;
             return *this;
         }
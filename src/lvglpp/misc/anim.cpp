@@ -4,9 +4,72 @@
  *  Author: Vincent Paeder
  *  License: MIT
  */
+#include <algorithm>
 #include "anim.h"
 
 namespace lvgl::misc {
+
+    // linear path without lv_anim_path_linear's 1024-step quantization;
+    // with values 0 and time, the animation value is the elapsed time
+    static int32_t exact_path_cb(const lv_anim_t * anim) {
+        if (anim->time == 0) return anim->end_value;
+        auto t = std::clamp<int32_t>(anim->act_time, 0, static_cast<int32_t>(anim->time));
+        return anim->start_value + static_cast<int32_t>(static_cast<int64_t>(anim->end_value - anim->start_value) * t / anim->time);
+    }
+
+    EasingTable::EasingTable(lv_anim_path_cb_t path_cb) {
+        lv_anim_t anim;
+        lv_anim_init(&anim);
+        anim.start_value = 0;
+        anim.end_value = resolution;
+        anim.time = resolution;
+        for (uint32_t n=0; n<=segments; n++) {
+            anim.act_time = n << shift;
+            this->table[n] = static_cast<int16_t>(path_cb(&anim));
+        }
+    }
+
+    EasingTable EasingTable::cubic_bezier(int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+        // x must be monotonic for the curve to be a function of time
+        x1 = std::clamp<int32_t>(x1, 0, resolution);
+        x2 = std::clamp<int32_t>(x2, 0, resolution);
+        auto bezier = [](int64_t u, int64_t p1, int64_t p2) -> int32_t {
+            // B(u) = 3(1-u)^2 u p1 + 3(1-u) u^2 p2 + u^3 end, with u scaled by resolution
+            int64_t v = resolution - u;
+            int64_t r = 3*v*v*u*p1 + 3*v*u*u*p2 + u*u*u*resolution;
+            return static_cast<int32_t>(r / (static_cast<int64_t>(resolution) * resolution * resolution));
+        };
+        // march along the curve parameter and invert x(u) at segment boundaries
+        EasingTable tbl;
+        constexpr int32_t steps = 4*resolution;
+        int32_t u = 0;
+        int32_t x_prev = 0, y_prev = 0;
+        for (uint32_t n=0; n<=segments; n++) {
+            int32_t x_target = n << shift;
+            int32_t x = bezier(u * resolution / steps, x1, x2);
+            int32_t y = bezier(u * resolution / steps, y1, y2);
+            while (x < x_target && u < steps) {
+                x_prev = x;
+                y_prev = y;
+                u++;
+                x = bezier(static_cast<int64_t>(u) * resolution / steps, x1, x2);
+                y = bezier(static_cast<int64_t>(u) * resolution / steps, y1, y2);
+            }
+            if (x > x_target && x > x_prev)
+                y = y_prev + (y - y_prev) * (x_target - x_prev) / (x - x_prev);
+            tbl.table[n] = static_cast<int16_t>(y);
+        }
+        tbl.table[0] = 0;
+        tbl.table[segments] = resolution;
+        return tbl;
+    }
+
+#if LV_USE_USER_DATA
+    int32_t EasingTable::path_cb(const lv_anim_t * anim) {
+        auto tbl = static_cast<const EasingTable*>(anim->user_data);
+        return tbl->map(anim->act_time, anim->time, anim->start_value, anim->end_value);
+    }
+#endif // LV_USE_USER_DATA
     
     Animation::Animation() {
         this->lv_obj = LvPointerType(lv_cls_alloc<lv_cls>());
@@ -46,9 +109,9 @@ namespace lvgl::misc {
         using CustomCbType = Callback<void, Animation&, int32_t>;
         this->custom_exec_cb = std::make_shared<CustomCbType>(exec_cb);
         auto f = [](lv_anim_t * lv_obj, int32_t val) {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->custom_exec_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<CustomCbType>(anim->custom_exec_cb);
+                auto & cb = *static_cast<CustomCbType*>(anim->custom_exec_cb.get());
                 cb(*anim, val);
             }
         };
@@ -65,9 +128,9 @@ namespace lvgl::misc {
         using PathCbType = Callback<int32_t, const Animation&>;
         this->path_cb = std::make_shared<PathCbType>(path_cb);
         auto f = [](const lv_anim_t * lv_obj) -> int32_t {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->path_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<PathCbType>(anim->path_cb);
+                auto & cb = *static_cast<PathCbType*>(anim->path_cb.get());
                 return cb(*anim);
             }
             return 0;
@@ -85,9 +148,9 @@ namespace lvgl::misc {
         using StartCbType = Callback<void, Animation&>;
         this->start_cb = std::make_shared<StartCbType>(start_cb);
         auto f = [](lv_anim_t * lv_obj) {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->start_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<StartCbType>(anim->start_cb);
+                auto & cb = *static_cast<StartCbType*>(anim->start_cb.get());
                 cb(*anim);
             }
         };
@@ -104,9 +167,9 @@ namespace lvgl::misc {
         using GetValueCbType = Callback<int32_t, Animation&>;
         this->get_value_cb = std::make_shared<GetValueCbType>(get_value_cb);
         auto f = [](lv_anim_t * lv_obj) -> int32_t {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->get_value_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<GetValueCbType>(anim->get_value_cb);
+                auto & cb = *static_cast<GetValueCbType*>(anim->get_value_cb.get());
                 return cb(*anim);
             }
             return 0;
@@ -124,9 +187,9 @@ namespace lvgl::misc {
         using ReadyCbType = Callback<void, Animation&>;
         this->ready_cb = std::make_shared<ReadyCbType>(ready_cb);
         auto f = [](lv_anim_t * lv_obj) {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->ready_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<ReadyCbType>(anim->ready_cb);
+                auto & cb = *static_cast<ReadyCbType*>(anim->ready_cb.get());
                 cb(*anim);
             }
         };
@@ -143,9 +206,9 @@ namespace lvgl::misc {
         using DeletedCbType = Callback<void, Animation&>;
         this->deleted_cb = std::make_shared<DeletedCbType>(deleted_cb);
         auto f = [](lv_anim_t * lv_obj) {
-            auto anim = reinterpret_cast<Animation*>(lv_obj->var);
+            auto anim = static_cast<Animation*>(lv_obj->var);
             if (anim->deleted_cb != nullptr) {
-                auto cb = *std::dynamic_pointer_cast<DeletedCbType>(anim->deleted_cb);
+                auto & cb = *static_cast<DeletedCbType*>(anim->deleted_cb.get());
                 cb(*anim);
             }
         };
@@ -191,8 +254,105 @@ namespace lvgl::misc {
     }
 #endif // LV_USE_USER_DATA
 
+    uint16_t Animation::global_time_scale = 256;
+    uint32_t Animation::global_frames_skipped = 0;
+    uint32_t Animation::global_frames_emitted = 0;
+
+    std::unordered_map<const lv_anim_t*, Animation::FrameGate> Animation::gates;
+
+    int32_t Animation::gate_path_cb(const lv_anim_t * anim) {
+        auto it = Animation::gates.find(anim);
+        if (it == Animation::gates.end())
+            return lv_anim_path_linear(anim);
+        auto & gate = it->second;
+        auto value = gate.path_cb != nullptr ? gate.path_cb(anim) : lv_anim_path_linear(anim);
+        if (value == anim->current_value)
+            return value;
+        if (value != anim->start_value && value != anim->end_value
+                && lv_tick_elaps(gate.last_frame) < gate.interval) {
+            // LVGL only calls exec_cb when the value changes
+            gate.counts->skipped++;
+            Animation::global_frames_skipped++;
+            return anim->current_value;
+        }
+        gate.last_frame = lv_tick_get();
+        gate.counts->emitted++;
+        Animation::global_frames_emitted++;
+        return value;
+    }
+
+    void Animation::set_frame_interval(uint32_t interval) {
+        this->frame_interval = interval;
+    }
+
+    void Animation::set_time_scale(uint16_t scale) {
+        this->time_scale = scale;
+    }
+
+    uint32_t Animation::get_frames_skipped() const {
+        return this->frame_counts->skipped;
+    }
+
+    uint32_t Animation::get_frames_emitted() const {
+        return this->frame_counts->emitted;
+    }
+
+    void Animation::set_global_frame_interval(uint32_t interval) {
+        lv_timer_set_period(lv_anim_get_timer(), interval);
+    }
+
+    void Animation::set_global_time_scale(uint16_t scale) {
+        Animation::global_time_scale = scale;
+    }
+
+    uint32_t Animation::get_global_frames_skipped() {
+        return Animation::global_frames_skipped;
+    }
+
+    uint32_t Animation::get_global_frames_emitted() {
+        return Animation::global_frames_emitted;
+    }
+
     void Animation::start() {
-        lv_anim_start(this->raw_ptr());
+        auto a = this->raw_ptr();
+        uint32_t scale = (static_cast<uint32_t>(this->time_scale) * Animation::global_time_scale) >> 8;
+        if (scale == 256 && this->frame_interval == 0) {
+            lv_anim_start(a);
+            return;
+        }
+        // LVGL copies the descriptor on start: adjust it for the copy, then
+        // restore it so that scaling doesn't compound over restarts
+        auto saved = *a;
+        if (scale != 256) {
+            auto scaled = [scale](uint32_t t) {
+                return static_cast<uint32_t>((static_cast<uint64_t>(t) * scale) >> 8);
+            };
+            a->time = scaled(a->time);
+            if (a->act_time < 0)
+                a->act_time = -static_cast<int32_t>(scaled(static_cast<uint32_t>(-a->act_time)));
+            a->playback_delay = scaled(a->playback_delay);
+            a->playback_time = scaled(a->playback_time);
+            a->repeat_delay = scaled(a->repeat_delay);
+        }
+        if (this->frame_interval > 0 && a->exec_cb != nullptr) {
+            // drop gates of animations that finished or were deleted
+            for (auto it = Animation::gates.begin(); it != Animation::gates.end(); ) {
+                if (lv_anim_get(it->second.var, it->second.exec_cb) != it->first)
+                    it = Animation::gates.erase(it);
+                else
+                    ++it;
+            }
+            auto path_cb = a->path_cb;
+            a->path_cb = Animation::gate_path_cb;
+            auto running = lv_anim_start(a);
+            *a = saved;
+            if (running != nullptr)
+                Animation::gates[running] = FrameGate{path_cb, running->var, running->exec_cb,
+                    this->frame_interval, lv_tick_get() - this->frame_interval, this->frame_counts};
+            return;
+        }
+        lv_anim_start(a);
+        *a = saved;
     }
 
     uint32_t Animation::get_delay() const {
@@ -203,6 +363,258 @@ namespace lvgl::misc {
         return lv_anim_get_playtime(const_cast<lv_cls_ptr>(this->raw_ptr()));
     }
 
+    AnimationGroup::AnimationGroup() {
+        this->lv_obj = LvPointerType(lv_cls_alloc<lv_cls>());
+        lv_anim_init(this->raw_ptr());
+        lv_anim_set_var(this->raw_ptr(), static_cast<void*>(this));
+        lv_anim_set_exec_cb(this->raw_ptr(), AnimationGroup::exec_trampoline);
+    }
+
+    AnimationGroup::~AnimationGroup() {
+        this->stop();
+    }
+
+    void AnimationGroup::exec_trampoline(void * self, int32_t time) {
+        auto group = static_cast<AnimationGroup*>(self);
+        auto cnt = group->targets.size();
+        int32_t duration = static_cast<int32_t>(group->duration);
+        auto easing = group->easing.get();
+        for (size_t n=0; n<cnt; n++) {
+            int32_t t = std::clamp<int32_t>(time - static_cast<int32_t>(group->phases[n]), 0, duration);
+            int32_t start = group->start_values[n];
+            int32_t end = group->end_values[n];
+            int32_t value;
+            if (easing != nullptr)
+                value = easing->map(t, duration, start, end);
+            else if (duration > 0)
+                value = start + static_cast<int32_t>((static_cast<int64_t>(end - start) * t) / duration);
+            else
+                value = end;
+            if (value != group->last_values[n]) {
+                group->last_values[n] = value;
+                group->setters[n](group->targets[n], value);
+            }
+        }
+    }
+
+    size_t AnimationGroup::add(void * target, lv_anim_exec_xcb_t setter, int32_t start, int32_t end, uint32_t phase) {
+        this->targets.push_back(target);
+        this->setters.push_back(setter);
+        this->start_values.push_back(start);
+        this->end_values.push_back(end);
+        this->phases.push_back(phase);
+        this->last_values.push_back(INT32_MIN);
+        return this->targets.size() - 1;
+    }
+
+    void AnimationGroup::set_values(size_t index, int32_t start, int32_t end) {
+        this->start_values[index] = start;
+        this->end_values[index] = end;
+        this->last_values[index] = INT32_MIN;
+    }
+
+    void AnimationGroup::set_phase(size_t index, uint32_t phase) {
+        this->phases[index] = phase;
+    }
+
+    void AnimationGroup::clear() {
+        this->stop();
+        this->targets.clear();
+        this->setters.clear();
+        this->start_values.clear();
+        this->end_values.clear();
+        this->phases.clear();
+        this->last_values.clear();
+    }
+
+    size_t AnimationGroup::size() const {
+        return this->targets.size();
+    }
+
+    void AnimationGroup::set_time(uint32_t duration) {
+        this->duration = duration;
+    }
+
+    void AnimationGroup::set_delay(uint32_t delay) {
+        lv_anim_set_delay(this->raw_ptr(), delay);
+    }
+
+    void AnimationGroup::set_easing(std::shared_ptr<const EasingTable> easing) {
+        this->easing = std::move(easing);
+    }
+
+    void AnimationGroup::set_playback(bool en) {
+        this->playback = en;
+    }
+
+    void AnimationGroup::set_repeat_count(uint16_t cnt) {
+        lv_anim_set_repeat_count(this->raw_ptr(), cnt);
+    }
+
+    void AnimationGroup::set_repeat_delay(uint32_t delay) {
+        lv_anim_set_repeat_delay(this->raw_ptr(), delay);
+    }
+
+    uint32_t AnimationGroup::get_playtime() const {
+        uint32_t max_phase = 0;
+        for (auto phase : this->phases)
+            max_phase = std::max(max_phase, phase);
+        return this->duration + max_phase;
+    }
+
+    void AnimationGroup::start() {
+        // the lv_anim_t value is the elapsed time (reversed on playback);
+        // easing is applied per target
+        auto total = this->get_playtime();
+        lv_anim_set_values(this->raw_ptr(), 0, static_cast<int32_t>(total));
+        lv_anim_set_time(this->raw_ptr(), total);
+        lv_anim_set_path_cb(this->raw_ptr(), exact_path_cb);
+        lv_anim_set_playback_time(this->raw_ptr(), this->playback ? total : 0);
+        std::fill(this->last_values.begin(), this->last_values.end(), INT32_MIN);
+        lv_anim_start(this->raw_ptr());
+    }
+
+    void AnimationGroup::stop() {
+        lv_anim_del(static_cast<void*>(this), AnimationGroup::exec_trampoline);
+    }
+
+    KeyframeTrack::KeyframeTrack(void * target, lv_anim_exec_xcb_t setter) : target(target), setter(setter) {}
+
+    void KeyframeTrack::add_keyframe(uint32_t time, int32_t value, std::shared_ptr<const EasingTable> easing) {
+        auto it = std::lower_bound(this->times.begin(), this->times.end(), time);
+        auto idx = std::distance(this->times.begin(), it);
+        if (it != this->times.end() && *it == time) {
+            this->values[idx] = value;
+            this->easings[idx] = std::move(easing);
+        } else {
+            this->times.insert(it, time);
+            this->values.insert(this->values.begin() + idx, value);
+            this->easings.insert(this->easings.begin() + idx, std::move(easing));
+        }
+        // rebuild segments
+        this->segments.clear();
+        for (size_t n=1; n<this->times.size(); n++)
+            this->segments.push_back({this->times[n-1], this->times[n] - this->times[n-1],
+                                      this->values[n-1], this->values[n], this->easings[n].get()});
+        this->cursor = 0;
+    }
+
+    void KeyframeTrack::clear() {
+        this->times.clear();
+        this->values.clear();
+        this->easings.clear();
+        this->segments.clear();
+        this->cursor = 0;
+        this->last_value = INT32_MIN;
+    }
+
+    size_t KeyframeTrack::find_segment(uint32_t time) {
+        // sequential playback stays in the same segment or moves to the next one
+        auto & cur = this->segments[this->cursor];
+        if (time >= cur.start && time <= cur.start + cur.span)
+            return this->cursor;
+        auto next = this->cursor + 1;
+        if (next < this->segments.size() && time >= this->segments[next].start
+                && time <= this->segments[next].start + this->segments[next].span)
+            return next;
+        auto it = std::upper_bound(this->segments.begin(), this->segments.end(), time,
+                                   [](uint32_t t, const Segment & seg) { return t < seg.start; });
+        return std::distance(this->segments.begin(), it) - 1;
+    }
+
+    int32_t KeyframeTrack::evaluate(uint32_t time) {
+        if (this->times.empty()) return 0;
+        if (time <= this->times.front()) return this->values.front();
+        if (time >= this->times.back()) return this->values.back();
+        this->cursor = this->find_segment(time);
+        auto & seg = this->segments[this->cursor];
+        int32_t t = static_cast<int32_t>(time - seg.start);
+        int32_t span = static_cast<int32_t>(seg.span);
+        if (seg.easing != nullptr)
+            return seg.easing->map(t, span, seg.start_value, seg.end_value);
+        return seg.start_value + static_cast<int32_t>((static_cast<int64_t>(seg.end_value - seg.start_value) * t) / span);
+    }
+
+    void KeyframeTrack::apply(uint32_t time) {
+        auto value = this->evaluate(time);
+        if (value != this->last_value) {
+            this->last_value = value;
+            this->setter(this->target, value);
+        }
+    }
+
+    void KeyframeTrack::reset() {
+        this->last_value = INT32_MIN;
+    }
+
+    uint32_t KeyframeTrack::get_duration() const {
+        return this->times.empty() ? 0 : this->times.back();
+    }
+
+    KeyframeAnimation::KeyframeAnimation() {
+        this->lv_obj = LvPointerType(lv_cls_alloc<lv_cls>());
+        lv_anim_init(this->raw_ptr());
+        lv_anim_set_var(this->raw_ptr(), static_cast<void*>(this));
+        lv_anim_set_exec_cb(this->raw_ptr(), KeyframeAnimation::exec_trampoline);
+        lv_anim_set_path_cb(this->raw_ptr(), exact_path_cb);
+    }
+
+    KeyframeAnimation::~KeyframeAnimation() {
+        this->stop();
+    }
+
+    void KeyframeAnimation::exec_trampoline(void * self, int32_t time) {
+        auto anim = static_cast<KeyframeAnimation*>(self);
+        auto t = static_cast<uint32_t>(std::max<int32_t>(time, 0));
+        for (auto & track : anim->tracks)
+            track.apply(t);
+    }
+
+    KeyframeTrack & KeyframeAnimation::add_track(void * target, lv_anim_exec_xcb_t setter) {
+        return this->tracks.emplace_back(target, setter);
+    }
+
+    void KeyframeAnimation::update() {
+        // the lv_anim_t value is the elapsed time, given by the exact linear path
+        auto duration = this->get_playtime();
+        lv_anim_set_values(this->raw_ptr(), 0, static_cast<int32_t>(duration));
+        lv_anim_set_time(this->raw_ptr(), duration);
+        for (auto & track : this->tracks)
+            track.reset();
+    }
+
+    void KeyframeAnimation::set_delay(uint32_t delay) {
+        lv_anim_set_delay(this->raw_ptr(), delay);
+    }
+
+    void KeyframeAnimation::set_repeat_count(uint16_t cnt) {
+        lv_anim_set_repeat_count(this->raw_ptr(), cnt);
+    }
+
+    void KeyframeAnimation::set_repeat_delay(uint32_t delay) {
+        lv_anim_set_repeat_delay(this->raw_ptr(), delay);
+    }
+
+    void KeyframeAnimation::set_early_apply(bool en) {
+        lv_anim_set_early_apply(this->raw_ptr(), en);
+    }
+
+    uint32_t KeyframeAnimation::get_playtime() const {
+        uint32_t duration = 0;
+        for (auto & track : this->tracks)
+            duration = std::max(duration, track.get_duration());
+        return duration;
+    }
+
+    void KeyframeAnimation::start() {
+        this->update();
+        lv_anim_start(this->raw_ptr());
+    }
+
+    void KeyframeAnimation::stop() {
+        lv_anim_del(static_cast<void*>(this), KeyframeAnimation::exec_trampoline);
+    }
+
     AnimationTimeline::AnimationTimeline() {
         this->lv_obj = LvPointerType(lv_anim_timeline_create());
     }
@@ -211,6 +623,11 @@ namespace lvgl::misc {
         lv_anim_timeline_add(this->raw_ptr(), start_time, const_cast<lv_anim_t*>(anim.raw_ptr()));
     }
 
+    void AnimationTimeline::add(uint32_t start_time, KeyframeAnimation & anim) {
+        anim.update();
+        lv_anim_timeline_add(this->raw_ptr(), start_time, anim.raw_ptr());
+    }
+
     uint32_t AnimationTimeline::start() {
         return lv_anim_timeline_start(this->raw_ptr());
     }
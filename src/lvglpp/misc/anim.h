@@ -5,6 +5,12 @@
  *  License: MIT
  */
 #pragma once
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "../lv_wrapper.h"
 
 /** \namespace lvgl::misc
@@ -12,10 +18,203 @@
  */
 namespace lvgl::misc {
 
+    /** \class EasingTable
+     *  \brief Animation path precomputed as a lookup table.
+     * 
+     *  The path is sampled at regular intervals once; evaluation is then
+     *  an integer interpolation between two table entries. A table can
+     *  be used as animation path by setting EasingTable::path_cb as path
+     *  callback and a pointer to the table as animation user data.
+     */
+    class EasingTable {
+    public:
+        /** \property static constexpr uint32_t segments
+         *  \brief Number of intervals the path is split into.
+         */
+        static constexpr uint32_t segments = 64;
+
+        /** \property static constexpr uint32_t resolution
+         *  \brief Span of path progress (equivalent to LVGL's animation resolution).
+         */
+        static constexpr uint32_t resolution = 1024;
+
+        /** \property static constexpr uint32_t resolution_shift
+         *  \brief log2(resolution).
+         */
+        static constexpr uint32_t resolution_shift = 10;
+
+    private:
+        /** \property static constexpr uint32_t shift
+         *  \brief log2(resolution / segments).
+         */
+        static constexpr uint32_t shift = 4;
+
+        /** \property std::array<int16_t, segments+1> table
+         *  \brief Path values at segment boundaries, 0 (start) to resolution (end).
+         *  Values may exceed this range for overshooting paths.
+         */
+        std::array<int16_t, segments+1> table;
+
+        /** \fn EasingTable()
+         *  \brief Default constructor. Table is left for factory functions to fill.
+         */
+        EasingTable() = default;
+
+    public:
+        /** \fn EasingTable(lv_anim_path_cb_t path_cb)
+         *  \brief Constructor sampling an LVGL path function.
+         *  \param path_cb: path function (e.g. lv_anim_path_ease_in_out).
+         */
+        EasingTable(lv_anim_path_cb_t path_cb);
+
+        /** \fn static EasingTable cubic_bezier(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+         *  \brief Creates a table for a cubic Bézier curve, as used by CSS easing
+         *  functions. End points are (0,0) and (resolution,resolution).
+         *  \param x1: first control point horizontal coordinate (0 to resolution).
+         *  \param y1: first control point vertical coordinate (may be out of 0 to resolution).
+         *  \param x2: second control point horizontal coordinate (0 to resolution).
+         *  \param y2: second control point vertical coordinate (may be out of 0 to resolution).
+         *  \returns easing table.
+         */
+        static EasingTable cubic_bezier(int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+        /** \fn int32_t get(int32_t t) const
+         *  \brief Evaluates path.
+         *  \param t: progress along path, 0 to resolution.
+         *  \returns path value, nominally 0 to resolution.
+         */
+        int32_t get(int32_t t) const {
+            if (t <= 0) return this->table[0];
+            if (t >= static_cast<int32_t>(resolution)) return this->table[segments];
+            auto idx = t >> shift;
+            auto frac = t & ((1 << shift) - 1);
+            int32_t v0 = this->table[idx];
+            int32_t v1 = this->table[idx + 1];
+            return v0 + (((v1 - v0) * frac) >> shift);
+        }
+
+        /** \fn int32_t map(int32_t act_time, int32_t time, int32_t start, int32_t end) const
+         *  \brief Evaluates path for a value going from start to end over given duration.
+         *  \param act_time: elapsed time.
+         *  \param time: total duration.
+         *  \param start: start value.
+         *  \param end: end value.
+         *  \returns value at given time.
+         */
+        int32_t map(int32_t act_time, int32_t time, int32_t start, int32_t end) const {
+            int32_t t = time > 0 ? static_cast<int32_t>((static_cast<int64_t>(act_time) * resolution) / time) : resolution;
+            return start + static_cast<int32_t>((static_cast<int64_t>(end - start) * this->get(t)) >> resolution_shift);
+        }
+
+#if LV_USE_USER_DATA
+        /** \fn static int32_t path_cb(const lv_anim_t * anim)
+         *  \brief Animation path callback reading the table from the animation user data.
+         *  \param anim: animation; user_data must point to an EasingTable.
+         *  \returns animation value.
+         */
+        static int32_t path_cb(const lv_anim_t * anim);
+#endif // LV_USE_USER_DATA
+    };
+
     /** \class Animation
      *  \brief Wraps a lv_anim_t object.
      */
     class Animation : public PointerWrapper<lv_anim_t, lv_mem_free> {
+    private:
+        /** \struct FrameCounts
+         *  \brief Frame counters of a frame gate.
+         */
+        struct FrameCounts {
+            /** \property uint32_t skipped
+             *  \brief Number of frames dropped.
+             */
+            uint32_t skipped = 0;
+
+            /** \property uint32_t emitted
+             *  \brief Number of frames let through.
+             */
+            uint32_t emitted = 0;
+        };
+
+        /** \struct FrameGate
+         *  \brief State of the frame gate of a running animation.
+         */
+        struct FrameGate {
+            /** \property lv_anim_path_cb_t path_cb
+             *  \brief Path function of the animation.
+             */
+            lv_anim_path_cb_t path_cb;
+
+            /** \property void * var
+             *  \brief Animation variable, used to tell if animation still runs.
+             */
+            void * var;
+
+            /** \property lv_anim_exec_xcb_t exec_cb
+             *  \brief Animation function, used to tell if animation still runs.
+             */
+            lv_anim_exec_xcb_t exec_cb;
+
+            /** \property uint32_t interval
+             *  \brief Minimum time between two frames, in ms.
+             */
+            uint32_t interval;
+
+            /** \property uint32_t last_frame
+             *  \brief Tick of last frame let through.
+             */
+            uint32_t last_frame;
+
+            /** \property std::shared_ptr<FrameCounts> counts
+             *  \brief Frame counters, shared with Animation instance.
+             */
+            std::shared_ptr<FrameCounts> counts;
+        };
+
+        /** \property static std::unordered_map<const lv_anim_t*, FrameGate> gates
+         *  \brief Frame gates, by running animation (LVGL's copy of the descriptor).
+         */
+        static std::unordered_map<const lv_anim_t*, FrameGate> gates;
+
+        /** \property uint32_t frame_interval
+         *  \brief Minimum time between two animation frames, in ms; 0=no limit.
+         */
+        uint32_t frame_interval = 0;
+
+        /** \property uint16_t time_scale
+         *  \brief Time scale factor, in 1/256 units.
+         */
+        uint16_t time_scale = 256;
+
+        /** \property std::shared_ptr<FrameCounts> frame_counts
+         *  \brief Frame counters of frame gate.
+         */
+        std::shared_ptr<FrameCounts> frame_counts = std::make_shared<FrameCounts>();
+
+        /** \property static uint16_t global_time_scale
+         *  \brief Time scale factor applied to all animations, in 1/256 units.
+         */
+        static uint16_t global_time_scale;
+
+        /** \property static uint32_t global_frames_skipped
+         *  \brief Number of frames dropped by frame gates of all animations.
+         */
+        static uint32_t global_frames_skipped;
+
+        /** \property static uint32_t global_frames_emitted
+         *  \brief Number of frames let through by frame gates of all animations.
+         */
+        static uint32_t global_frames_emitted;
+
+        /** \fn static int32_t gate_path_cb(const lv_anim_t * anim)
+         *  \brief Frame gate, installed as path function. Returns the current
+         *  value, which LVGL doesn't apply again, until enough time elapsed
+         *  since previous frame; start and end values always go through.
+         *  \param anim: running animation.
+         *  \returns animation value.
+         */
+        static int32_t gate_path_cb(const lv_anim_t * anim);
+
     public:
         using PointerWrapper::PointerWrapper;
 
@@ -124,8 +323,7 @@ namespace lvgl::misc {
          */
         template <class T> T & get_var() {
             assert(this->var != nullptr);
-            auto v = *std::dynamic_pointer_cast<Variable<T>>(this->var);
-            return v();
+            return (*static_cast<Variable<T>*>(this->var.get()))();
         }
 
         /** \fn void set_exec_cb(lv_anim_exec_xcb_t exec_cb)
@@ -157,8 +355,8 @@ namespace lvgl::misc {
             // definition of callback wrapper function; this will call C++ callback
             // with stored var
             auto f = [](void * lv_obj, int32_t value) {
-                auto anim = reinterpret_cast<Animation*>(lv_obj);
-                auto cb = *std::dynamic_pointer_cast<ExecCbType>(anim->exec_cb);
+                auto anim = static_cast<Animation*>(lv_obj);
+                auto & cb = *static_cast<ExecCbType*>(anim->exec_cb.get());
                 cb(anim->get_var<T>(), value);
             };
             lv_anim_set_exec_cb(this->raw_ptr(), f);
@@ -317,6 +515,59 @@ namespace lvgl::misc {
         void set_user_data(void * user_data);
 #endif // LV_USE_USER_DATA
 
+        /** \fn void set_frame_interval(uint32_t interval)
+         *  \brief Limits the animation frame rate. Intermediate values coming
+         *  sooner than interval after the previous frame are dropped; start
+         *  and end values always go through. Animation variable and callbacks
+         *  are left untouched. Takes effect on next start.
+         *  \param interval: minimum time between frames, in ms; 0=no limit.
+         */
+        void set_frame_interval(uint32_t interval);
+
+        /** \fn void set_time_scale(uint16_t scale)
+         *  \brief Scales animation durations and delays. Takes effect on next start.
+         *  \param scale: scale factor, in 1/256 units (256=normal speed, 512=half speed).
+         */
+        void set_time_scale(uint16_t scale);
+
+        /** \fn uint32_t get_frames_skipped() const
+         *  \brief Gets the number of frames dropped by frame rate limit.
+         *  \returns number of frames.
+         */
+        uint32_t get_frames_skipped() const;
+
+        /** \fn uint32_t get_frames_emitted() const
+         *  \brief Gets the number of frames let through by frame rate limit.
+         *  \returns number of frames.
+         */
+        uint32_t get_frames_emitted() const;
+
+        /** \fn static void set_global_frame_interval(uint32_t interval)
+         *  \brief Sets the period of LVGL's animation timer, which limits
+         *  the frame rate of all animations.
+         *  \param interval: timer period, in ms.
+         */
+        static void set_global_frame_interval(uint32_t interval);
+
+        /** \fn static void set_global_time_scale(uint16_t scale)
+         *  \brief Scales durations and delays of animations started afterwards.
+         *  Combines with per-animation time scale.
+         *  \param scale: scale factor, in 1/256 units.
+         */
+        static void set_global_time_scale(uint16_t scale);
+
+        /** \fn static uint32_t get_global_frames_skipped()
+         *  \brief Gets the number of frames dropped by frame rate limits of all animations.
+         *  \returns number of frames.
+         */
+        static uint32_t get_global_frames_skipped();
+
+        /** \fn static uint32_t get_global_frames_emitted()
+         *  \brief Gets the number of frames let through by frame rate limits of all animations.
+         *  \returns number of frames.
+         */
+        static uint32_t get_global_frames_emitted();
+
         /** \fn void start()
          *  \brief Starts animation.
          */
@@ -352,6 +603,541 @@ namespace lvgl::misc {
         
     };
 
+    /** \class TypedAnimation
+     *  \brief Wraps a lv_anim_t object animating a variable of known type.
+     * 
+     *  Unlike Animation, the variable type and the callable are template
+     *  parameters: the callable is stored inline and invoked through a static
+     *  trampoline, without type erasure or heap-allocated callback containers.
+     *  The callable can be a function pointer, a lambda (with or without
+     *  captures) or any function object taking (T &, int32_t).
+     *  \tparam T: type of the variable to animate.
+     *  \tparam F: type of the callable used to animate variable.
+     */
+    template <class T, class F> class TypedAnimation : public PointerWrapper<lv_anim_t, lv_mem_free> {
+    private:
+        /** \property T * var
+         *  \brief Pointer to animated variable.
+         */
+        T * var;
+
+        /** \property F exec
+         *  \brief Callable used to animate variable.
+         */
+        F exec;
+
+        /** \fn static void exec_trampoline(void * self, int32_t value)
+         *  \brief Animation callback. The lv_anim_t variable points to
+         *  the TypedAnimation instance.
+         *  \param self: pointer to TypedAnimation instance.
+         *  \param value: current animation value.
+         */
+        static void exec_trampoline(void * self, int32_t value) {
+            auto anim = static_cast<TypedAnimation*>(self);
+            anim->exec(*anim->var, value);
+        }
+
+    public:
+        /** \fn TypedAnimation(T & var, F exec)
+         *  \brief Constructor.
+         *  \param var: variable to animate. Must remain allocated.
+         *  \param exec: callable used to animate variable.
+         */
+        TypedAnimation(T & var, F exec) : var(&var), exec(std::move(exec)) {
+            this->lv_obj = LvPointerType(lv_cls_alloc<lv_cls>());
+            lv_anim_init(this->raw_ptr());
+            lv_anim_set_var(this->raw_ptr(), static_cast<void*>(this));
+            lv_anim_set_exec_cb(this->raw_ptr(), TypedAnimation::exec_trampoline);
+        }
+
+        /** \fn ~TypedAnimation()
+         *  \brief Destructor. Stops the animation, as LVGL would otherwise
+         *  keep a pointer to this instance.
+         */
+        ~TypedAnimation() {
+            lv_anim_del(static_cast<void*>(this), TypedAnimation::exec_trampoline);
+        }
+
+        /** \fn T & get_var()
+         *  \brief Gets animation variable.
+         *  \returns animation variable.
+         */
+        T & get_var() {
+            return *this->var;
+        }
+
+        /** \fn void set_time(uint32_t duration)
+         *  \brief Sets animation duration.
+         *  \param duration: duration, in ms.
+         */
+        void set_time(uint32_t duration) {
+            lv_anim_set_time(this->raw_ptr(), duration);
+        }
+
+        /** \fn void set_delay(uint32_t delay)
+         *  \brief Sets animation delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_delay(uint32_t delay) {
+            lv_anim_set_delay(this->raw_ptr(), delay);
+        }
+
+        /** \fn void set_values(int32_t start, int32_t end)
+         *  \brief Sets start and end values.
+         *  \param start: start value.
+         *  \param end: end value.
+         */
+        void set_values(int32_t start, int32_t end) {
+            lv_anim_set_values(this->raw_ptr(), start, end);
+        }
+
+        /** \fn void set_path_cb(lv_anim_path_cb_t path_cb)
+         *  \brief Sets the function that calculates the animation's path.
+         *  \param path_cb: callback function.
+         */
+        void set_path_cb(lv_anim_path_cb_t path_cb) {
+            lv_anim_set_path_cb(this->raw_ptr(), path_cb);
+        }
+
+        /** \fn void set_playback_time(uint32_t time)
+         *  \brief Sets the animation playback duration.
+         *  \param time: duration, in ms; 0=no playback.
+         */
+        void set_playback_time(uint32_t time) {
+            lv_anim_set_playback_time(this->raw_ptr(), time);
+        }
+
+        /** \fn void set_playback_delay(uint32_t delay)
+         *  \brief Sets the animation playback delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_playback_delay(uint32_t delay) {
+            lv_anim_set_playback_delay(this->raw_ptr(), delay);
+        }
+
+        /** \fn void set_repeat_count(uint16_t cnt)
+         *  \brief Sets the animation repeat count.
+         *  \param cnt: repeat count.
+         */
+        void set_repeat_count(uint16_t cnt) {
+            lv_anim_set_repeat_count(this->raw_ptr(), cnt);
+        }
+
+        /** \fn void set_repeat_delay(uint32_t delay)
+         *  \brief Sets the animation repeat delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_repeat_delay(uint32_t delay) {
+            lv_anim_set_repeat_delay(this->raw_ptr(), delay);
+        }
+
+        /** \fn void set_early_apply(bool en)
+         *  \brief Sets when the animation anounces it has started.
+         *  \param en: if false, anounces after delay; if true, anounces before.
+         */
+        void set_early_apply(bool en) {
+            lv_anim_set_early_apply(this->raw_ptr(), en);
+        }
+
+        /** \fn void start()
+         *  \brief Starts animation.
+         */
+        void start() {
+            lv_anim_start(this->raw_ptr());
+        }
+
+        /** \fn uint32_t get_playtime() const
+         *  \brief Gets animation duration.
+         *  \returns duration, in ms.
+         */
+        uint32_t get_playtime() const {
+            return lv_anim_get_playtime(const_cast<lv_cls_ptr>(this->raw_ptr()));
+        }
+    };
+
+    /** \class AnimationGroup
+     *  \brief Animates many targets in sync from a single lv_anim_t object.
+     * 
+     *  Targets, setters and values are stored as parallel arrays. On each
+     *  frame, the animation value is the elapsed time and all targets are
+     *  evaluated in one loop. Each target can be delayed by a phase offset
+     *  relative to the group start. Setters are only called when the target
+     *  value changes.
+     */
+    class AnimationGroup : public PointerWrapper<lv_anim_t, lv_mem_free> {
+    private:
+        /** \property std::vector<void*> targets
+         *  \brief Animated variables.
+         */
+        std::vector<void*> targets;
+
+        /** \property std::vector<lv_anim_exec_xcb_t> setters
+         *  \brief Functions used to animate variables.
+         */
+        std::vector<lv_anim_exec_xcb_t> setters;
+
+        /** \property std::vector<int32_t> start_values
+         *  \brief Start values.
+         */
+        std::vector<int32_t> start_values;
+
+        /** \property std::vector<int32_t> end_values
+         *  \brief End values.
+         */
+        std::vector<int32_t> end_values;
+
+        /** \property std::vector<uint32_t> phases
+         *  \brief Time offsets from group start, in ms.
+         */
+        std::vector<uint32_t> phases;
+
+        /** \property std::vector<int32_t> last_values
+         *  \brief Last values passed to setters.
+         */
+        std::vector<int32_t> last_values;
+
+        /** \property uint32_t duration
+         *  \brief Duration of each target animation, in ms.
+         */
+        uint32_t duration = 500;
+
+        /** \property bool playback
+         *  \brief If true, the group plays back after reaching the end.
+         */
+        bool playback = false;
+
+        /** \property std::shared_ptr<const EasingTable> easing
+         *  \brief Animation path; linear if null.
+         */
+        std::shared_ptr<const EasingTable> easing;
+
+        /** \fn static void exec_trampoline(void * self, int32_t time)
+         *  \brief Animation callback evaluating all targets.
+         *  \param self: pointer to AnimationGroup instance.
+         *  \param time: elapsed time since group start, in ms.
+         */
+        static void exec_trampoline(void * self, int32_t time);
+
+    public:
+        /** \fn AnimationGroup()
+         *  \brief Default constructor.
+         */
+        AnimationGroup();
+
+        /** \fn ~AnimationGroup()
+         *  \brief Destructor. Stops the animation.
+         */
+        ~AnimationGroup();
+
+        /** \fn size_t add(void * target, lv_anim_exec_xcb_t setter, int32_t start, int32_t end, uint32_t phase = 0)
+         *  \brief Adds a target to the group.
+         *  \param target: pointer to animated variable. Must remain allocated.
+         *  \param setter: function used to animate variable.
+         *  \param start: start value.
+         *  \param end: end value.
+         *  \param phase: time offset from group start, in ms.
+         *  \returns target index.
+         */
+        size_t add(void * target, lv_anim_exec_xcb_t setter, int32_t start, int32_t end, uint32_t phase = 0);
+
+        /** \fn void set_values(size_t index, int32_t start, int32_t end)
+         *  \brief Sets start and end values of a target.
+         *  \param index: target index.
+         *  \param start: start value.
+         *  \param end: end value.
+         */
+        void set_values(size_t index, int32_t start, int32_t end);
+
+        /** \fn void set_phase(size_t index, uint32_t phase)
+         *  \brief Sets time offset of a target. Takes effect on next start.
+         *  \param index: target index.
+         *  \param phase: time offset from group start, in ms.
+         */
+        void set_phase(size_t index, uint32_t phase);
+
+        /** \fn void clear()
+         *  \brief Stops the animation and removes all targets.
+         */
+        void clear();
+
+        /** \fn size_t size() const
+         *  \brief Gets the number of targets.
+         *  \returns number of targets.
+         */
+        size_t size() const;
+
+        /** \fn void set_time(uint32_t duration)
+         *  \brief Sets duration of each target animation. Takes effect on next start.
+         *  \param duration: duration, in ms.
+         */
+        void set_time(uint32_t duration);
+
+        /** \fn void set_delay(uint32_t delay)
+         *  \brief Sets group delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_delay(uint32_t delay);
+
+        /** \fn void set_easing(std::shared_ptr<const EasingTable> easing)
+         *  \brief Sets the animation path shared by all targets.
+         *  \param easing: easing table; null for linear path.
+         */
+        void set_easing(std::shared_ptr<const EasingTable> easing);
+
+        /** \fn void set_playback(bool en)
+         *  \brief Enables/disables playback. Takes effect on next start.
+         *  \param en: if true, the group plays back after reaching the end.
+         */
+        void set_playback(bool en);
+
+        /** \fn void set_repeat_count(uint16_t cnt)
+         *  \brief Sets the group repeat count.
+         *  \param cnt: repeat count.
+         */
+        void set_repeat_count(uint16_t cnt);
+
+        /** \fn void set_repeat_delay(uint32_t delay)
+         *  \brief Sets the group repeat delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_repeat_delay(uint32_t delay);
+
+        /** \fn uint32_t get_playtime() const
+         *  \brief Gets group duration, including phase offsets.
+         *  \returns duration, in ms.
+         */
+        uint32_t get_playtime() const;
+
+        /** \fn void start()
+         *  \brief Starts animation.
+         */
+        void start();
+
+        /** \fn void stop()
+         *  \brief Stops animation.
+         */
+        void stop();
+    };
+
+    /** \class KeyframeTrack
+     *  \brief Keyframes of one animated property.
+     * 
+     *  Keyframes are turned into segments as they are added. Evaluation
+     *  first tries the segment used last (or the next one), which covers
+     *  normal playback, and otherwise does a binary search over segments.
+     */
+    class KeyframeTrack {
+    private:
+        /** \struct Segment
+         *  \brief Interval between two consecutive keyframes.
+         */
+        struct Segment {
+            /** \property uint32_t start
+             *  \brief Segment start time, in ms.
+             */
+            uint32_t start;
+
+            /** \property uint32_t span
+             *  \brief Segment duration, in ms.
+             */
+            uint32_t span;
+
+            /** \property int32_t start_value
+             *  \brief Value at segment start.
+             */
+            int32_t start_value;
+
+            /** \property int32_t end_value
+             *  \brief Value at segment end.
+             */
+            int32_t end_value;
+
+            /** \property const EasingTable * easing
+             *  \brief Segment path; linear if null.
+             */
+            const EasingTable * easing;
+        };
+
+        /** \property void * target
+         *  \brief Animated variable.
+         */
+        void * target;
+
+        /** \property lv_anim_exec_xcb_t setter
+         *  \brief Function used to animate variable.
+         */
+        lv_anim_exec_xcb_t setter;
+
+        /** \property std::vector<uint32_t> times
+         *  \brief Keyframe times, in ms, in increasing order.
+         */
+        std::vector<uint32_t> times;
+
+        /** \property std::vector<int32_t> values
+         *  \brief Keyframe values.
+         */
+        std::vector<int32_t> values;
+
+        /** \property std::vector<std::shared_ptr<const EasingTable>> easings
+         *  \brief Path leading to each keyframe.
+         */
+        std::vector<std::shared_ptr<const EasingTable>> easings;
+
+        /** \property std::vector<Segment> segments
+         *  \brief Segments between keyframes.
+         */
+        std::vector<Segment> segments;
+
+        /** \property size_t cursor
+         *  \brief Index of last evaluated segment.
+         */
+        size_t cursor = 0;
+
+        /** \property int32_t last_value
+         *  \brief Last value passed to setter.
+         */
+        int32_t last_value = INT32_MIN;
+
+        /** \fn size_t find_segment(uint32_t time)
+         *  \brief Finds the segment containing given time.
+         *  \param time: time, in ms; must be within track duration.
+         *  \returns segment index.
+         */
+        size_t find_segment(uint32_t time);
+
+    public:
+        /** \fn KeyframeTrack(void * target, lv_anim_exec_xcb_t setter)
+         *  \brief Constructor.
+         *  \param target: pointer to animated variable. Must remain allocated.
+         *  \param setter: function used to animate variable.
+         */
+        KeyframeTrack(void * target, lv_anim_exec_xcb_t setter);
+
+        /** \fn void add_keyframe(uint32_t time, int32_t value, std::shared_ptr<const EasingTable> easing = nullptr)
+         *  \brief Adds a keyframe. A keyframe at an existing time replaces it.
+         *  \param time: keyframe time, in ms.
+         *  \param value: value at keyframe time.
+         *  \param easing: path from previous keyframe; linear if null.
+         */
+        void add_keyframe(uint32_t time, int32_t value, std::shared_ptr<const EasingTable> easing = nullptr);
+
+        /** \fn void clear()
+         *  \brief Removes all keyframes.
+         */
+        void clear();
+
+        /** \fn int32_t evaluate(uint32_t time)
+         *  \brief Computes value at given time.
+         *  \param time: time, in ms.
+         *  \returns value; first or last keyframe value outside track range.
+         */
+        int32_t evaluate(uint32_t time);
+
+        /** \fn void apply(uint32_t time)
+         *  \brief Sets variable to its value at given time, if it changed.
+         *  \param time: time, in ms.
+         */
+        void apply(uint32_t time);
+
+        /** \fn void reset()
+         *  \brief Forgets the last applied value, so that next apply calls setter.
+         */
+        void reset();
+
+        /** \fn uint32_t get_duration() const
+         *  \brief Gets time of last keyframe.
+         *  \returns duration, in ms.
+         */
+        uint32_t get_duration() const;
+    };
+
+    /** \class KeyframeAnimation
+     *  \brief Plays keyframe tracks from a single lv_anim_t object.
+     * 
+     *  The animation value is the elapsed time; all tracks are evaluated
+     *  from it. When added to an AnimationTimeline, seeking with
+     *  set_progress evaluates each track with a binary search.
+     */
+    class KeyframeAnimation : public PointerWrapper<lv_anim_t, lv_mem_free> {
+    private:
+        /** \property std::deque<KeyframeTrack> tracks
+         *  \brief Animated tracks. A deque keeps references to tracks valid.
+         */
+        std::deque<KeyframeTrack> tracks;
+
+        /** \fn static void exec_trampoline(void * self, int32_t time)
+         *  \brief Animation callback evaluating all tracks.
+         *  \param self: pointer to KeyframeAnimation instance.
+         *  \param time: elapsed time, in ms.
+         */
+        static void exec_trampoline(void * self, int32_t time);
+
+    public:
+        /** \fn KeyframeAnimation()
+         *  \brief Default constructor.
+         */
+        KeyframeAnimation();
+
+        /** \fn ~KeyframeAnimation()
+         *  \brief Destructor. Stops the animation.
+         */
+        ~KeyframeAnimation();
+
+        /** \fn KeyframeTrack & add_track(void * target, lv_anim_exec_xcb_t setter)
+         *  \brief Adds a track.
+         *  \param target: pointer to animated variable. Must remain allocated.
+         *  \param setter: function used to animate variable.
+         *  \returns reference to new track.
+         */
+        KeyframeTrack & add_track(void * target, lv_anim_exec_xcb_t setter);
+
+        /** \fn void update()
+         *  \brief Updates animation duration from tracks. This is called by
+         *  start and when adding the animation to a timeline.
+         */
+        void update();
+
+        /** \fn void set_delay(uint32_t delay)
+         *  \brief Sets animation delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_delay(uint32_t delay);
+
+        /** \fn void set_repeat_count(uint16_t cnt)
+         *  \brief Sets the animation repeat count.
+         *  \param cnt: repeat count.
+         */
+        void set_repeat_count(uint16_t cnt);
+
+        /** \fn void set_repeat_delay(uint32_t delay)
+         *  \brief Sets the animation repeat delay.
+         *  \param delay: delay, in ms.
+         */
+        void set_repeat_delay(uint32_t delay);
+
+        /** \fn void set_early_apply(bool en)
+         *  \brief Sets whether first keyframes are applied before delay has elapsed.
+         *  \param en: if true, applies before delay; if false, after.
+         */
+        void set_early_apply(bool en);
+
+        /** \fn uint32_t get_playtime() const
+         *  \brief Gets animation duration.
+         *  \returns duration, in ms.
+         */
+        uint32_t get_playtime() const;
+
+        /** \fn void start()
+         *  \brief Starts animation.
+         */
+        void start();
+
+        /** \fn void stop()
+         *  \brief Stops animation.
+         */
+        void stop();
+    };
+
     /** \class AnimationTimeline
      *  \brief Wraps a lv_anim_timeline_t object.
      */
@@ -369,6 +1155,23 @@ namespace lvgl::misc {
          */
         void add(uint32_t start_time, const Animation & anim);
 
+        /** \fn template <class T, class F> void add(uint32_t start_time, const TypedAnimation<T, F> & anim)
+         *  \brief Adds an animation to the timeline.
+         *  \param start_time: animation start time (overrides animation delay).
+         *  \param anim: animation instance.
+         */
+        template <class T, class F> void add(uint32_t start_time, const TypedAnimation<T, F> & anim) {
+            lv_anim_timeline_add(this->raw_ptr(), start_time, const_cast<lv_anim_t*>(anim.raw_ptr()));
+        }
+
+        /** \fn void add(uint32_t start_time, KeyframeAnimation & anim)
+         *  \brief Adds a keyframe animation to the timeline. Keyframes
+         *  added afterwards don't change the duration seen by the timeline.
+         *  \param start_time: animation start time (overrides animation delay).
+         *  \param anim: animation instance.
+         */
+        void add(uint32_t start_time, KeyframeAnimation & anim);
+
         /** \fn uint32_t start()
          *  \brief Starts playing through timeline.
          *  \returns how long the timeline has played already.
@@ -0,0 +1,291 @@
+/** \file assetpack.cpp
+ *  \brief Implementation file for a read-only file system serving packed assets.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <cstring>
+#include "assetpack.h"
+
+// FileSystem requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    static constexpr uint32_t header_size = 16;
+    static constexpr uint32_t entry_size = 20;
+
+    static inline uint16_t get_u16(const uint8_t * p) {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    static inline uint32_t get_u32(const uint8_t * p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+             | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    static inline std::string_view strip_slash(std::string_view path) {
+        while (!path.empty() && path.front() == '/')
+            path.remove_prefix(1);
+        return path;
+    }
+
+    AssetPackFileSystem::AssetPackFileSystem(char letter, const std::string & pack_path)
+        : FileSystem(letter), block(LVGLPP_ASSETPACK_BLOCK_SIZE) {
+        // LVGL only sets the descriptor on success; File closes it if not null
+        auto f = this->pack.raw_ptr();
+        std::memset(f, 0, sizeof(lv_fs_file_t));
+        auto res = lv_fs_open(f, pack_path.c_str(), LV_FS_MODE_RD);
+        if (res != LV_FS_RES_OK) {
+            f->file_d = nullptr;
+            LV_LOG_WARN("cannot open asset pack %s", pack_path.c_str());
+            return;
+        }
+        this->valid = this->load();
+        if (!this->valid)
+            LV_LOG_WARN("invalid asset pack %s", pack_path.c_str());
+    }
+
+    bool AssetPackFileSystem::load() {
+        uint8_t header[header_size];
+        uint32_t nr;
+        if (this->read_pack(0, header, header_size, &nr) != LV_FS_RES_OK || nr != header_size)
+            return false;
+        if (std::memcmp(header, "LVPK", 4) != 0 || get_u16(header + 4) != version)
+            return false;
+        uint32_t count = get_u32(header + 8);
+        uint32_t names_size = get_u32(header + 12);
+        // read table of contents and name table in one go
+        std::vector<uint8_t> toc(static_cast<size_t>(count) * entry_size + names_size);
+        if (this->read_pack(header_size, toc.data(), toc.size(), &nr) != LV_FS_RES_OK || nr != toc.size())
+            return false;
+        this->entries.resize(count);
+        for (uint32_t n=0; n<count; n++) {
+            auto p = toc.data() + n * entry_size;
+            auto & e = this->entries[n];
+            e.name_offset = get_u32(p);
+            e.name_len = get_u16(p + 4);
+            e.flags = get_u16(p + 6);
+            e.offset = get_u32(p + 8);
+            e.stored_size = get_u32(p + 12);
+            e.size = get_u32(p + 16);
+            if (static_cast<uint64_t>(e.name_offset) + e.name_len > names_size)
+                return false;
+        }
+        auto names_start = toc.data() + static_cast<size_t>(count) * entry_size;
+        this->names.assign(names_start, names_start + names_size);
+        return true;
+    }
+
+    std::string_view AssetPackFileSystem::get_name(const Entry & entry) const {
+        return std::string_view(this->names.data() + entry.name_offset, entry.name_len);
+    }
+
+    const AssetPackFileSystem::Entry * AssetPackFileSystem::find(std::string_view path) const {
+        path = strip_slash(path);
+        auto it = std::lower_bound(this->entries.begin(), this->entries.end(), path,
+                                   [this](const Entry & e, std::string_view p) { return this->get_name(e) < p; });
+        if (it == this->entries.end() || this->get_name(*it) != path)
+            return nullptr;
+        return &*it;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::read_pack(uint32_t offset, void * buf, uint32_t btr, uint32_t * br) {
+        // all entries share the pack file: only seek when needed
+        if (this->pack_pos != offset) {
+            auto res = this->pack.seek(offset, LV_FS_SEEK_SET);
+            if (res != LV_FS_RES_OK) {
+                this->pack_pos = UINT32_MAX;
+                return res;
+            }
+            this->pack_pos = offset;
+        }
+        lv_fs_res_t res;
+        *br = this->pack.read_into(buf, btr, &res);
+        this->pack_pos = res == LV_FS_RES_OK ? this->pack_pos + *br : UINT32_MAX;
+        return res;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::fetch(uint32_t offset, uint32_t len, const uint8_t ** data, uint32_t * avail) {
+        if (offset < this->block_offset || static_cast<uint64_t>(offset) + len > static_cast<uint64_t>(this->block_offset) + this->block_len) {
+            uint32_t nr;
+            auto res = this->read_pack(offset, this->block.data(), this->block.size(), &nr);
+            if (res != LV_FS_RES_OK) {
+                this->block_len = 0;
+                return res;
+            }
+            this->block_offset = offset;
+            this->block_len = nr;
+        }
+        *data = this->block.data() + (offset - this->block_offset);
+        *avail = this->block_offset + this->block_len - offset;
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::read_rle(OpenEntry * file, uint8_t * buf, uint32_t btr, uint32_t * br) {
+        // runs are a control byte c followed by c+1 literal bytes (c < 128),
+        // or by one byte repeated c-126 times (c >= 128); stored data is
+        // read a block at a time
+        auto & e = *file->entry;
+        if (file->pos < file->decoded) {
+            // seeking backwards: decode again from start
+            file->decoded = file->src_pos = file->run = 0;
+        }
+        uint32_t done = 0;
+        while (done < btr && file->decoded < e.size) {
+            const uint8_t * p;
+            uint32_t avail;
+            if (file->run == 0) {
+                uint32_t want = std::min<uint32_t>(2, e.stored_size - file->src_pos);
+                if (want == 0) break;
+                auto res = this->fetch(e.offset + file->src_pos, want, &p, &avail);
+                if (res != LV_FS_RES_OK) return res;
+                if (avail == 0) break;
+                if (p[0] < 128) {
+                    file->run = p[0] + 1;
+                    file->repeat = -1;
+                    file->src_pos += 1;
+                } else {
+                    if (avail < 2 || want < 2) break;
+                    file->run = p[0] - 126;
+                    file->repeat = p[1];
+                    file->src_pos += 2;
+                }
+            }
+            // bytes of this run before the requested position are skipped
+            uint32_t skip = std::min(file->run, file->pos > file->decoded ? file->pos - file->decoded : 0);
+            uint32_t n = skip > 0 ? skip : std::min(file->run, btr - done);
+            if (file->repeat >= 0) {
+                if (skip == 0)
+                    std::memset(buf + done, file->repeat, n);
+            } else if (skip > 0) {
+                file->src_pos += n;
+            } else {
+                // literal runs are at most 128 bytes: one fetch covers them
+                n = std::min(n, e.stored_size - file->src_pos);
+                auto res = this->fetch(e.offset + file->src_pos, n, &p, &avail);
+                if (res != LV_FS_RES_OK) return res;
+                n = std::min(n, avail);
+                if (n == 0) break;
+                std::memcpy(buf + done, p, n);
+                file->src_pos += n;
+            }
+            file->run -= n;
+            file->decoded += n;
+            if (skip == 0) {
+                done += n;
+                file->pos += n;
+            }
+        }
+        *br = done;
+        return LV_FS_RES_OK;
+    }
+
+    bool AssetPackFileSystem::ready_cb() {
+        return this->valid;
+    }
+
+    void * AssetPackFileSystem::open_cb(const char * path, lv_fs_mode_t mode) {
+        if (!this->valid || (mode & LV_FS_MODE_WR)) return nullptr;
+        auto entry = this->find(path);
+        if (entry == nullptr) return nullptr;
+        return static_cast<void*>(new OpenEntry{entry, 0, 0, 0, 0, -1});
+    }
+
+    lv_fs_res_t AssetPackFileSystem::close_cb(void * file_p) {
+        delete static_cast<OpenEntry*>(file_p);
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) {
+        auto file = static_cast<OpenEntry*>(file_p);
+        auto & e = *file->entry;
+        btr = std::min(btr, e.size - std::min(file->pos, e.size));
+        if (e.flags & flag_rle)
+            return this->read_rle(file, static_cast<uint8_t*>(buf), btr, br);
+        auto res = this->read_pack(e.offset + file->pos, buf, btr, br);
+        file->pos += *br;
+        return res;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) {
+        *bw = 0;
+        return LV_FS_RES_DENIED;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) {
+        auto file = static_cast<OpenEntry*>(file_p);
+        switch (whence) {
+            case LV_FS_SEEK_SET:
+                file->pos = pos;
+                break;
+            case LV_FS_SEEK_CUR:
+                file->pos += pos;
+                break;
+            case LV_FS_SEEK_END:
+                file->pos = file->entry->size + pos;
+                break;
+            default:
+                return LV_FS_RES_INV_PARAM;
+        }
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::tell_cb(void * file_p, uint32_t * pos_p) {
+        *pos_p = static_cast<OpenEntry*>(file_p)->pos;
+        return LV_FS_RES_OK;
+    }
+
+    void * AssetPackFileSystem::dir_open_cb(const char * path) {
+        if (!this->valid) return nullptr;
+        std::string prefix(strip_slash(path));
+        if (!prefix.empty() && prefix.back() != '/')
+            prefix += '/';
+        // entries are sorted: those of the directory follow the first one
+        // not before the prefix
+        auto it = std::lower_bound(this->entries.begin(), this->entries.end(), std::string_view(prefix),
+                                   [this](const Entry & e, std::string_view p) { return this->get_name(e) < p; });
+        return static_cast<void*>(new DirCursor{prefix, static_cast<size_t>(it - this->entries.begin()), ""});
+    }
+
+    lv_fs_res_t AssetPackFileSystem::dir_read_cb(void * rddir_p, char * fn) {
+        auto dir = static_cast<DirCursor*>(rddir_p);
+        fn[0] = '\0';
+        while (dir->index < this->entries.size()) {
+            auto name = this->get_name(this->entries[dir->index]);
+            if (name.substr(0, dir->prefix.size()) != dir->prefix) break;
+            dir->index++;
+            name.remove_prefix(dir->prefix.size());
+            auto slash = name.find('/');
+            if (slash == std::string_view::npos) {
+                // file; LVGL names are limited to 256 bytes
+                auto n = std::min<size_t>(name.size(), 255);
+                std::memcpy(fn, name.data(), n);
+                fn[n] = '\0';
+                return LV_FS_RES_OK;
+            }
+            // subdirectory, reported once with a leading slash
+            name = name.substr(0, slash);
+            if (name == dir->last_dir) continue;
+            dir->last_dir = std::string(name);
+            auto n = std::min<size_t>(name.size(), 254);
+            fn[0] = '/';
+            std::memcpy(fn + 1, name.data(), n);
+            fn[n + 1] = '\0';
+            return LV_FS_RES_OK;
+        }
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t AssetPackFileSystem::dir_close_cb(void * rddir_p) {
+        delete static_cast<DirCursor*>(rddir_p);
+        return LV_FS_RES_OK;
+    }
+
+    uint32_t AssetPackFileSystem::get_entry_count() const {
+        return this->entries.size();
+    }
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,265 @@
+/** \file assetpack.h
+ *  \brief Header file for a read-only file system serving packed assets.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <string_view>
+#include "fs.h"
+
+/** \def LVGLPP_ASSETPACK_BLOCK_SIZE
+ *  \brief Size of the block read at once from the pack when decoding
+ *  compressed entries.
+ */
+#ifndef LVGLPP_ASSETPACK_BLOCK_SIZE
+#define LVGLPP_ASSETPACK_BLOCK_SIZE 512
+#endif
+
+// FileSystem requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    /** \class AssetPackFileSystem
+     *  \brief Read-only file system serving the entries of an asset pack,
+     *  itself read through another LVGL file system. The pack is opened
+     *  once; its table of contents is loaded in memory at construction
+     *  and paths are resolved by binary search. Entries can be stored or
+     *  RLE-compressed; compressed entries are decoded while reading.
+     *  Packs are built with tools/lvpack.py.
+     * 
+     *  Pack layout (little-endian):
+     *  - header: "LVPK", version (u16), reserved (u16), entry count (u32),
+     *    name table size (u32);
+     *  - entries, sorted by name: name offset (u32), name length (u16),
+     *    flags (u16, bit 0 = RLE), data offset (u32), stored size (u32),
+     *    original size (u32);
+     *  - name table (names without leading slash);
+     *  - entry data, each starting at a multiple of the alignment given
+     *    to tools/lvpack.py.
+     */
+    class AssetPackFileSystem : public FileSystem {
+    public:
+        /** \property static constexpr uint16_t version
+         *  \brief Supported pack format version.
+         */
+        static constexpr uint16_t version = 1;
+
+        /** \property static constexpr uint16_t flag_rle
+         *  \brief Entry flag for RLE compression.
+         */
+        static constexpr uint16_t flag_rle = 1;
+
+    private:
+        /** \struct Entry
+         *  \brief Table of contents entry.
+         */
+        struct Entry {
+            /** \property uint32_t name_offset
+             *  \brief Offset of name in name table.
+             */
+            uint32_t name_offset;
+
+            /** \property uint16_t name_len
+             *  \brief Name length.
+             */
+            uint16_t name_len;
+
+            /** \property uint16_t flags
+             *  \brief Entry flags.
+             */
+            uint16_t flags;
+
+            /** \property uint32_t offset
+             *  \brief Offset of data in pack.
+             */
+            uint32_t offset;
+
+            /** \property uint32_t stored_size
+             *  \brief Size of data in pack.
+             */
+            uint32_t stored_size;
+
+            /** \property uint32_t size
+             *  \brief Size of original file.
+             */
+            uint32_t size;
+        };
+
+        /** \struct OpenEntry
+         *  \brief Open entry descriptor.
+         */
+        struct OpenEntry {
+            /** \property const Entry * entry
+             *  \brief Table of contents entry.
+             */
+            const Entry * entry;
+
+            /** \property uint32_t pos
+             *  \brief Position in decoded data.
+             */
+            uint32_t pos;
+
+            /** \property uint32_t decoded
+             *  \brief RLE: number of bytes decoded so far.
+             */
+            uint32_t decoded;
+
+            /** \property uint32_t src_pos
+             *  \brief RLE: position in stored data.
+             */
+            uint32_t src_pos;
+
+            /** \property uint32_t run
+             *  \brief RLE: bytes left in current run.
+             */
+            uint32_t run;
+
+            /** \property int16_t repeat
+             *  \brief RLE: repeated byte, or -1 for a literal run.
+             */
+            int16_t repeat;
+        };
+
+        /** \struct DirCursor
+         *  \brief Open directory descriptor.
+         */
+        struct DirCursor {
+            /** \property std::string prefix
+             *  \brief Directory path, with trailing slash unless root.
+             */
+            std::string prefix;
+
+            /** \property size_t index
+             *  \brief Next entry to examine.
+             */
+            size_t index;
+
+            /** \property std::string last_dir
+             *  \brief Last subdirectory returned.
+             */
+            std::string last_dir;
+        };
+
+        /** \property File pack
+         *  \brief Pack file.
+         */
+        File pack;
+
+        /** \property uint32_t pack_pos
+         *  \brief Access pointer position in pack file.
+         */
+        uint32_t pack_pos = UINT32_MAX;
+
+        /** \property std::vector<uint8_t> block
+         *  \brief Block of pack data, for decoding compressed entries.
+         */
+        std::vector<uint8_t> block;
+
+        /** \property uint32_t block_offset
+         *  \brief Position of block in pack.
+         */
+        uint32_t block_offset = 0;
+
+        /** \property uint32_t block_len
+         *  \brief Number of valid bytes in block.
+         */
+        uint32_t block_len = 0;
+
+        /** \property std::vector<Entry> entries
+         *  \brief Table of contents.
+         */
+        std::vector<Entry> entries;
+
+        /** \property std::vector<char> names
+         *  \brief Name table.
+         */
+        std::vector<char> names;
+
+        /** \property bool valid
+         *  \brief If true, pack was loaded successfully.
+         */
+        bool valid = false;
+
+        /** \fn bool load()
+         *  \brief Loads table of contents.
+         *  \returns true if successful, false otherwise.
+         */
+        bool load();
+
+        /** \fn std::string_view get_name(const Entry & entry) const
+         *  \brief Gets entry name.
+         *  \param entry: table of contents entry.
+         *  \returns entry name.
+         */
+        std::string_view get_name(const Entry & entry) const;
+
+        /** \fn const Entry * find(std::string_view path) const
+         *  \brief Finds an entry by path.
+         *  \param path: entry path; leading slash is ignored.
+         *  \returns pointer to entry, or nullptr if not found.
+         */
+        const Entry * find(std::string_view path) const;
+
+        /** \fn lv_fs_res_t read_pack(uint32_t offset, void * buf, uint32_t btr, uint32_t * br)
+         *  \brief Reads from pack file at given offset.
+         *  \param offset: position in pack.
+         *  \param buf: recipient buffer.
+         *  \param btr: number of bytes to read.
+         *  \param br: receives number of bytes read.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t read_pack(uint32_t offset, void * buf, uint32_t btr, uint32_t * br);
+
+        /** \fn lv_fs_res_t fetch(uint32_t offset, uint32_t len, const uint8_t ** data, uint32_t * avail)
+         *  \brief Gets pack data from block, reading a new block if the
+         *  requested range isn't in it.
+         *  \param offset: position in pack.
+         *  \param len: number of bytes needed.
+         *  \param data: receives pointer to data.
+         *  \param avail: receives number of bytes available from data; less
+         *  than len only at end of pack.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t fetch(uint32_t offset, uint32_t len, const uint8_t ** data, uint32_t * avail);
+
+        /** \fn lv_fs_res_t read_rle(OpenEntry * file, uint8_t * buf, uint32_t btr, uint32_t * br)
+         *  \brief Reads from a RLE-compressed entry.
+         *  \param file: open entry.
+         *  \param buf: recipient buffer.
+         *  \param btr: number of bytes to read.
+         *  \param br: receives number of bytes read.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t read_rle(OpenEntry * file, uint8_t * buf, uint32_t btr, uint32_t * br);
+
+    protected:
+        bool ready_cb() override;
+        void * open_cb(const char * path, lv_fs_mode_t mode) override;
+        lv_fs_res_t close_cb(void * file_p) override;
+        lv_fs_res_t read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) override;
+        lv_fs_res_t write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) override;
+        lv_fs_res_t seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) override;
+        lv_fs_res_t tell_cb(void * file_p, uint32_t * pos_p) override;
+        void * dir_open_cb(const char * path) override;
+        lv_fs_res_t dir_read_cb(void * rddir_p, char * fn) override;
+        lv_fs_res_t dir_close_cb(void * rddir_p) override;
+
+    public:
+        /** \fn AssetPackFileSystem(char letter, const std::string & pack_path)
+         *  \brief Constructor.
+         *  \param letter: registration letter for LVGL.
+         *  \param pack_path: LVGL path of pack file (e.g. "S:/assets.pack").
+         */
+        AssetPackFileSystem(char letter, const std::string & pack_path);
+
+        /** \fn uint32_t get_entry_count() const
+         *  \brief Gets the number of entries in pack.
+         *  \returns number of entries.
+         */
+        uint32_t get_entry_count() const;
+    };
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,289 @@
+/** \file binlog.cpp
+ *  \brief Implementation file for a deferred-format binary logger.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "binlog.h"
+
+namespace lvgl::misc {
+
+    static uint8_t ring[LVGLPP_BINLOG_SIZE];
+    // free-running positions: head is only written by producer, tail by consumer
+    static std::atomic<uint32_t> head{0};
+    static std::atomic<uint32_t> tail{0};
+    std::atomic<uint32_t> BinaryLog::dropped{0};
+
+    static std::thread worker;
+    static std::mutex worker_mutex;
+    static std::condition_variable worker_cond;
+    static bool worker_stopping = false;
+
+    static const char * level_names[] = {"Trace", "Info", "Warn", "Error", "User"};
+
+    static void ring_write(uint32_t pos, const uint8_t * data, size_t len) {
+        uint32_t start = pos & (LVGLPP_BINLOG_SIZE - 1);
+        size_t first = std::min<size_t>(len, LVGLPP_BINLOG_SIZE - start);
+        std::memcpy(ring + start, data, first);
+        std::memcpy(ring, data + first, len - first);
+    }
+
+    static void ring_read(uint32_t pos, uint8_t * data, size_t len) {
+        uint32_t start = pos & (LVGLPP_BINLOG_SIZE - 1);
+        size_t first = std::min<size_t>(len, LVGLPP_BINLOG_SIZE - start);
+        std::memcpy(data, ring + start, first);
+        std::memcpy(data + first, ring, len - first);
+    }
+
+    /** \struct Record
+     *  \brief Decoded view of a record.
+     */
+    struct Record {
+        const LogFormat * format;
+        uint32_t timestamp;
+        uint8_t n_args;
+        const uint8_t * args;
+        size_t args_len;
+    };
+
+    // pops next record into buf; returns false if log is empty
+    static bool pop(uint8_t * buf, Record & rec) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        uint16_t len;
+        ring_read(t, reinterpret_cast<uint8_t*>(&len), sizeof(len));
+        ring_read(t, buf, len);
+        tail.store(t + len, std::memory_order_release);
+        uint64_t format;
+        std::memcpy(&rec.n_args, buf + 2, 1);
+        std::memcpy(&rec.timestamp, buf + 4, 4);
+        std::memcpy(&format, buf + 8, 8);
+        rec.format = reinterpret_cast<const LogFormat*>(static_cast<uintptr_t>(format));
+        rec.args = buf + 16;
+        rec.args_len = len - 16;
+        return true;
+    }
+
+    // formats a single conversion spec with a stored argument
+    static void format_arg(std::string & out, std::string spec, char conv, const uint8_t *& arg, const uint8_t * end) {
+        char tmp[320];
+        if (arg >= end) {
+            out += spec;
+            return;
+        }
+        char tag = static_cast<char>(*arg++);
+        int64_t i = 0;
+        uint64_t u = 0;
+        double d = 0;
+        std::string_view s;
+        if (tag == 's') {
+            uint8_t n = *arg++;
+            s = std::string_view(reinterpret_cast<const char*>(arg), n);
+            arg += n;
+        } else {
+            std::memcpy(&u, arg, 8);
+            std::memcpy(&i, arg, 8);
+            std::memcpy(&d, arg, 8);
+            arg += 8;
+        }
+        // length modifiers are replaced to match the stored type
+        while (!spec.empty() && std::strchr("hlLqjzt", spec.back()) != nullptr)
+            spec.pop_back();
+        if (conv == 's' || tag == 's') {
+            std::string str;
+            if (tag == 's') str = std::string(s);
+            else if (tag == 'd') str = std::to_string(d);
+            else if (tag == 'i') str = std::to_string(i);
+            else str = std::to_string(u);
+            spec += 's';
+            std::snprintf(tmp, sizeof(tmp), spec.c_str(), str.c_str());
+        } else if (conv == 'p') {
+            spec += 'p';
+            std::snprintf(tmp, sizeof(tmp), spec.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(u)));
+        } else if (std::strchr("eEfFgGaA", conv) != nullptr) {
+            spec += conv;
+            std::snprintf(tmp, sizeof(tmp), spec.c_str(), tag == 'd' ? d : tag == 'i' ? static_cast<double>(i) : static_cast<double>(u));
+        } else if (conv == 'c') {
+            spec += 'c';
+            std::snprintf(tmp, sizeof(tmp), spec.c_str(), static_cast<int>(tag == 'd' ? static_cast<int64_t>(d) : i));
+        } else {
+            spec += "ll";
+            spec += conv;
+            if (conv == 'd' || conv == 'i')
+                std::snprintf(tmp, sizeof(tmp), spec.c_str(), static_cast<long long>(tag == 'd' ? static_cast<int64_t>(d) : i));
+            else
+                std::snprintf(tmp, sizeof(tmp), spec.c_str(), static_cast<unsigned long long>(tag == 'd' ? static_cast<uint64_t>(d) : u));
+        }
+        out += tmp;
+    }
+
+    static void format_record(std::string & out, const Record & rec) {
+        out.clear();
+        auto format = rec.format;
+        if (format->file != nullptr) {
+            char tmp[48];
+            std::snprintf(tmp, sizeof(tmp), "[%s]\t(%u.%03u)\t", level_names[format->level < 5 ? format->level : 4],
+                          static_cast<unsigned>(rec.timestamp / 1000), static_cast<unsigned>(rec.timestamp % 1000));
+            out += tmp;
+        }
+        auto arg = rec.args;
+        auto end = rec.args + rec.args_len;
+        for (auto p = format->format; *p != '\0'; p++) {
+            if (*p != '%') {
+                out += *p;
+                continue;
+            }
+            if (p[1] == '%') {
+                out += '%';
+                p++;
+                continue;
+            }
+            auto spec_end = p + 1;
+            while (*spec_end != '\0' && std::strchr("diouxXeEfFgGaAcsp", *spec_end) == nullptr)
+                spec_end++;
+            if (*spec_end == '\0') {
+                out += p;
+                break;
+            }
+            format_arg(out, std::string(p, spec_end), *spec_end, arg, end);
+            p = spec_end;
+        }
+        if (format->file != nullptr) {
+            out += " \t(in ";
+            out += format->file;
+            out += " line #";
+            out += std::to_string(format->line);
+            out += ')';
+        } else {
+            // preformatted LVGL messages end with a line break
+            while (!out.empty() && out.back() == '\n')
+                out.pop_back();
+        }
+    }
+
+    void BinaryLog::set_header(uint8_t * buf, size_t len, const LogFormat * format, size_t n_args) {
+        uint16_t l = static_cast<uint16_t>(len);
+        uint32_t timestamp = lv_tick_get();
+        uint64_t f = reinterpret_cast<uintptr_t>(format);
+        std::memcpy(buf, &l, 2);
+        buf[2] = static_cast<uint8_t>(n_args);
+        buf[3] = 0;
+        std::memcpy(buf + 4, &timestamp, 4);
+        std::memcpy(buf + 8, &f, 8);
+    }
+
+    void BinaryLog::push(const uint8_t * buf, size_t len) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (len > LVGLPP_BINLOG_SIZE - (h - tail.load(std::memory_order_acquire))) {
+            dropped++;
+            return;
+        }
+        ring_write(h, buf, len);
+        head.store(h + len, std::memory_order_release);
+    }
+
+    size_t BinaryLog::drain(const TextSink & sink) {
+        uint8_t buf[max_record_size];
+        std::string line;
+        Record rec;
+        size_t count = 0;
+        while (pop(buf, rec)) {
+            format_record(line, rec);
+            sink(line.c_str());
+            count++;
+        }
+        return count;
+    }
+
+    size_t BinaryLog::dump(const BinarySink & sink) {
+        static const uint8_t stream_header[] = {'L', 'V', 'B', 'L', 1, 0};
+        uint8_t buf[max_record_size];
+        std::unordered_set<const LogFormat*> defined;
+        std::string chunk;
+        Record rec;
+        size_t count = 0;
+        sink(stream_header, sizeof(stream_header));
+        auto put_u16 = [&chunk](uint16_t v) { chunk.append(reinterpret_cast<const char*>(&v), 2); };
+        auto put_str = [&chunk, &put_u16](const char * s) {
+            auto n = static_cast<uint16_t>(s != nullptr ? std::strlen(s) : 0);
+            put_u16(n);
+            chunk.append(s != nullptr ? s : "", n);
+        };
+        while (pop(buf, rec)) {
+            chunk.clear();
+            uint64_t id = reinterpret_cast<uintptr_t>(rec.format);
+            if (defined.insert(rec.format).second) {
+                // format definition: 'F', id, level, line, format, file
+                chunk += 'F';
+                chunk.append(reinterpret_cast<const char*>(&id), 8);
+                chunk += static_cast<char>(rec.format->level);
+                uint32_t line = static_cast<uint32_t>(rec.format->line);
+                chunk.append(reinterpret_cast<const char*>(&line), 4);
+                put_str(rec.format->format);
+                put_str(rec.format->file);
+            }
+            // message: 'M', id, timestamp, argument count, argument bytes
+            chunk += 'M';
+            chunk.append(reinterpret_cast<const char*>(&id), 8);
+            chunk.append(reinterpret_cast<const char*>(&rec.timestamp), 4);
+            chunk += static_cast<char>(rec.n_args);
+            put_u16(static_cast<uint16_t>(rec.args_len));
+            chunk.append(reinterpret_cast<const char*>(rec.args), rec.args_len);
+            sink(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size());
+            count++;
+        }
+        return count;
+    }
+
+    bool BinaryLog::start_worker(const TextSink & sink, uint32_t period) {
+        std::lock_guard<std::mutex> lock(worker_mutex);
+        if (worker.joinable()) return false;
+        worker_stopping = false;
+        worker = std::thread([sink, period]() {
+            std::unique_lock<std::mutex> lock(worker_mutex);
+            while (!worker_stopping) {
+                worker_cond.wait_for(lock, std::chrono::milliseconds(period));
+                lock.unlock();
+                drain(sink);
+                lock.lock();
+            }
+            lock.unlock();
+            drain(sink);
+        });
+        return true;
+    }
+
+    void BinaryLog::stop_worker() {
+        {
+            std::lock_guard<std::mutex> lock(worker_mutex);
+            if (!worker.joinable()) return;
+            worker_stopping = true;
+        }
+        worker_cond.notify_all();
+        worker.join();
+    }
+
+    uint32_t BinaryLog::get_dropped() {
+        return dropped.load();
+    }
+
+    uint32_t BinaryLog::get_pending() {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+#if LV_USE_LOG
+    void BinaryLog::register_lvgl_bridge() {
+        static const LogFormat lvgl_format{"%s", nullptr, 0, LV_LOG_LEVEL_USER};
+        lv_log_register_print_cb([](const char * buf) {
+            write(&lvgl_format, buf);
+        });
+    }
+#endif // LV_USE_LOG
+
+}
@@ -0,0 +1,264 @@
+/** \file binlog.h
+ *  \brief Header file for a deferred-format binary logger.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "../lv_wrapper.h"
+
+/** \def LVGLPP_BINLOG_SIZE
+ *  \brief Size of the log ring buffer, in bytes. Must be a power of 2.
+ */
+#ifndef LVGLPP_BINLOG_SIZE
+#define LVGLPP_BINLOG_SIZE 4096
+#endif
+
+/** \def LVGLPP_BINLOG_LEVEL
+ *  \brief Minimum level of messages logged with LVGLPP_LOG.
+ */
+#ifndef LVGLPP_BINLOG_LEVEL
+#define LVGLPP_BINLOG_LEVEL LV_LOG_LEVEL_INFO
+#endif
+
+namespace lvgl::misc {
+
+    /** \struct LogFormat
+     *  \brief Static description of a log call site. Its address identifies
+     *  the format in records.
+     */
+    struct LogFormat {
+        /** \property const char * format
+         *  \brief printf-style format string.
+         */
+        const char * format;
+
+        /** \property const char * file
+         *  \brief Source file, or nullptr for preformatted messages.
+         */
+        const char * file;
+
+        /** \property int line
+         *  \brief Source line.
+         */
+        int line;
+
+        /** \property uint8_t level
+         *  \brief Log level (LV_LOG_LEVEL_*).
+         */
+        uint8_t level;
+    };
+
+    /** \class BinaryLog
+     *  \brief Logger storing format identifiers and raw arguments in a
+     *  lock-free ring buffer, formatting them later: on demand with drain,
+     *  on a worker thread, or offline with tools/lvlogdec.py from the output
+     *  of dump. Supported arguments are integers, enums, floating-point
+     *  numbers, pointers and strings (copied, up to 255 bytes). There must be
+     *  a single writer thread (usually LVGL's) and a single reader thread.
+     *  Messages that don't fit in the buffer are dropped and counted.
+     */
+    class BinaryLog {
+    public:
+        /** \typedef TextSink
+         *  \brief Receives formatted log lines.
+         */
+        using TextSink = std::function<void(const char *)>;
+
+        /** \typedef BinarySink
+         *  \brief Receives binary log stream data.
+         */
+        using BinarySink = std::function<void(const uint8_t *, size_t)>;
+
+        /** \fn template <class... Args> static void write(const LogFormat * format, const Args &... args)
+         *  \brief Stores a message.
+         *  \tparam Args: argument types.
+         *  \param format: call site description; must outlive the log.
+         *  \param args: format arguments.
+         */
+        template <class... Args>
+        static void write(const LogFormat * format, const Args &... args) {
+            uint8_t buf[max_record_size];
+            size_t len = header_size;
+            bool fits = (encode(buf, len, args) && ...);
+            if (!fits) {
+                dropped++;
+                return;
+            }
+            set_header(buf, len, format, sizeof...(Args));
+            push(buf, len);
+        }
+
+        /** \fn static size_t drain(const TextSink & sink)
+         *  \brief Formats and removes stored messages.
+         *  \param sink: receives formatted lines, without line break.
+         *  \returns number of messages formatted.
+         */
+        static size_t drain(const TextSink & sink);
+
+        /** \fn static size_t dump(const BinarySink & sink)
+         *  \brief Removes stored messages and outputs them as a binary
+         *  stream, to be decoded with tools/lvlogdec.py. Each call produces
+         *  a self-contained chunk including the formats it uses.
+         *  \param sink: receives stream data.
+         *  \returns number of messages written.
+         */
+        static size_t dump(const BinarySink & sink);
+
+        /** \fn static bool start_worker(const TextSink & sink, uint32_t period = 50)
+         *  \brief Starts a thread draining messages periodically.
+         *  \param sink: receives formatted lines, on worker thread.
+         *  \param period: drain period, in milliseconds.
+         *  \returns true if started, false if a worker is already running.
+         */
+        static bool start_worker(const TextSink & sink, uint32_t period = 50);
+
+        /** \fn static void stop_worker()
+         *  \brief Stops drain thread, after a last drain.
+         */
+        static void stop_worker();
+
+        /** \fn static uint32_t get_dropped()
+         *  \brief Gets the number of dropped messages.
+         *  \returns number of messages.
+         */
+        static uint32_t get_dropped();
+
+        /** \fn static uint32_t get_pending()
+         *  \brief Gets the number of bytes waiting in buffer.
+         *  \returns number of bytes.
+         */
+        static uint32_t get_pending();
+
+#if LV_USE_LOG
+        /** \fn static void register_lvgl_bridge()
+         *  \brief Registers a LVGL print callback storing LVGL messages in
+         *  this log, so that they get printed out of LVGL thread. LVGL
+         *  still formats them.
+         */
+        static void register_lvgl_bridge();
+#endif // LV_USE_LOG
+
+    private:
+        /** \property static constexpr size_t header_size
+         *  \brief Record header size: length (2), argument count (1),
+         *  padding (1), timestamp (4), format (8).
+         */
+        static constexpr size_t header_size = 16;
+
+        /** \property static constexpr size_t max_record_size
+         *  \brief Maximum record size, in bytes.
+         */
+        static constexpr size_t max_record_size = 512;
+
+        static_assert((LVGLPP_BINLOG_SIZE & (LVGLPP_BINLOG_SIZE - 1)) == 0, "LVGLPP_BINLOG_SIZE must be a power of 2");
+        static_assert(LVGLPP_BINLOG_SIZE >= max_record_size, "LVGLPP_BINLOG_SIZE is too small");
+
+        /** \property static std::atomic<uint32_t> dropped
+         *  \brief Number of dropped messages.
+         */
+        static std::atomic<uint32_t> dropped;
+
+        /** \fn static void set_header(uint8_t * buf, size_t len, const LogFormat * format, size_t n_args)
+         *  \brief Fills record header.
+         *  \param buf: record buffer.
+         *  \param len: record length.
+         *  \param format: call site description.
+         *  \param n_args: number of arguments.
+         */
+        static void set_header(uint8_t * buf, size_t len, const LogFormat * format, size_t n_args);
+
+        /** \fn static void push(const uint8_t * buf, size_t len)
+         *  \brief Copies a record into ring buffer, or drops it if full.
+         *  \param buf: record.
+         *  \param len: record length.
+         */
+        static void push(const uint8_t * buf, size_t len);
+
+        /** \fn static bool put(uint8_t * buf, size_t & len, char tag, const void * data, size_t size)
+         *  \brief Appends a tagged value to a record.
+         *  \param buf: record buffer.
+         *  \param len: record length, updated.
+         *  \param tag: value type tag.
+         *  \param data: value bytes.
+         *  \param size: number of value bytes.
+         *  \returns true if value fits, false otherwise.
+         */
+        static bool put(uint8_t * buf, size_t & len, char tag, const void * data, size_t size) {
+            if (len + 1 + size > max_record_size) return false;
+            buf[len++] = static_cast<uint8_t>(tag);
+            std::memcpy(buf + len, data, size);
+            len += size;
+            return true;
+        }
+
+        /** \fn static bool put_string(uint8_t * buf, size_t & len, std::string_view str)
+         *  \brief Appends a string to a record, truncated to 255 bytes.
+         *  \param buf: record buffer.
+         *  \param len: record length, updated.
+         *  \param str: string.
+         *  \returns true if string fits, false otherwise.
+         */
+        static bool put_string(uint8_t * buf, size_t & len, std::string_view str) {
+            uint8_t n = static_cast<uint8_t>(std::min<size_t>(str.size(), 255));
+            if (len + 2 + n > max_record_size) return false;
+            buf[len++] = 's';
+            buf[len++] = n;
+            std::memcpy(buf + len, str.data(), n);
+            len += n;
+            return true;
+        }
+
+        /** \fn template <class T> static bool encode(uint8_t * buf, size_t & len, const T & arg)
+         *  \brief Appends an argument to a record.
+         *  \tparam T: argument type.
+         *  \param buf: record buffer.
+         *  \param len: record length, updated.
+         *  \param arg: argument.
+         *  \returns true if argument fits, false otherwise.
+         */
+        template <class T>
+        static bool encode(uint8_t * buf, size_t & len, const T & arg) {
+            if constexpr (std::is_enum_v<T>) {
+                return encode(buf, len, static_cast<std::underlying_type_t<T>>(arg));
+            } else if constexpr (std::is_integral_v<T>) {
+                if constexpr (std::is_signed_v<T>) {
+                    int64_t v = arg;
+                    return put(buf, len, 'i', &v, sizeof(v));
+                } else {
+                    uint64_t v = arg;
+                    return put(buf, len, 'u', &v, sizeof(v));
+                }
+            } else if constexpr (std::is_floating_point_v<T>) {
+                double v = arg;
+                return put(buf, len, 'd', &v, sizeof(v));
+            } else if constexpr (std::is_same_v<std::decay_t<T>, char*> || std::is_same_v<std::decay_t<T>, const char*>) {
+                return put_string(buf, len, arg != nullptr ? std::string_view(arg) : std::string_view("(null)"));
+            } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+                return put_string(buf, len, std::string_view(arg));
+            } else {
+                static_assert(std::is_pointer_v<T>, "unsupported log argument type");
+                uint64_t v = reinterpret_cast<uintptr_t>(arg);
+                return put(buf, len, 'p', &v, sizeof(v));
+            }
+        }
+    };
+
+}
+
+/** \def LVGLPP_LOG(level, fmt, ...)
+ *  \brief Logs a message with BinaryLog if level is at least LVGLPP_BINLOG_LEVEL.
+ */
+#define LVGLPP_LOG(level, fmt, ...) do { \
+        if constexpr ((level) >= LVGLPP_BINLOG_LEVEL) { \
+            static const ::lvgl::misc::LogFormat lvglpp_log_format{fmt, __FILE__, __LINE__, (level)}; \
+            ::lvgl::misc::BinaryLog::write(&lvglpp_log_format, ##__VA_ARGS__); \
+        } \
+    } while (0)
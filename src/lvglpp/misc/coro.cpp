@@ -0,0 +1,138 @@
+/** \file coro.cpp
+ *  \brief Implementation file for C++20 coroutines scheduled by LVGL.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include "coro.h"
+
+// coroutines need C++20; awaitables store the coroutine handle as user_data
+#if __cplusplus >= 202002L && LV_USE_USER_DATA
+#include <cstddef>
+#include "anim.h"
+#include "../core/object.h"
+
+namespace lvgl::misc {
+
+    // frame storage; free frames are chained through their first bytes
+    union PooledFrame {
+        PooledFrame * next;
+        alignas(std::max_align_t) uint8_t data[LVGLPP_CORO_FRAME_SIZE];
+    };
+    static PooledFrame frames[LVGLPP_CORO_FRAME_COUNT];
+    static PooledFrame * free_frames = nullptr;
+    static bool pool_ready = false;
+    static uint32_t frames_used = 0;
+    static uint32_t frame_overflows = 0;
+
+    static bool is_pooled(void * frame) {
+        auto p = static_cast<PooledFrame*>(frame);
+        return p >= frames && p < frames + LVGLPP_CORO_FRAME_COUNT;
+    }
+
+    void * FramePool::allocate(size_t size) {
+        if (!pool_ready) {
+            for (size_t n=0; n<LVGLPP_CORO_FRAME_COUNT; n++)
+                frames[n].next = n+1 < LVGLPP_CORO_FRAME_COUNT ? &frames[n+1] : nullptr;
+            free_frames = frames;
+            pool_ready = true;
+        }
+        if (size <= sizeof(PooledFrame) && free_frames != nullptr) {
+            auto frame = free_frames;
+            free_frames = frame->next;
+            frames_used++;
+            return static_cast<void*>(frame);
+        }
+        frame_overflows++;
+        return lv_mem_alloc(size);
+    }
+
+    void FramePool::deallocate(void * frame) {
+        if (is_pooled(frame)) {
+            auto p = static_cast<PooledFrame*>(frame);
+            p->next = free_frames;
+            free_frames = p;
+            frames_used--;
+        } else {
+            lv_mem_free(frame);
+        }
+    }
+
+    uint32_t FramePool::get_used() {
+        return frames_used;
+    }
+
+    uint32_t FramePool::get_overflows() {
+        return frame_overflows;
+    }
+
+    void SleepAwaiter::await_suspend(std::coroutine_handle<> handle) {
+        auto f = [](lv_timer_t * timer) {
+            std::coroutine_handle<>::from_address(timer->user_data).resume();
+        };
+        auto timer = lv_timer_create(f, this->period, handle.address());
+        // LVGL deletes the timer after its single run
+        lv_timer_set_repeat_count(timer, 1);
+    }
+
+    void AnimationAwaiter::deleted_trampoline(lv_anim_t * a) {
+        auto awaiter = static_cast<AnimationAwaiter*>(a->user_data);
+        auto handle = awaiter->handle;
+        a->user_data = awaiter->user_data;
+        if (awaiter->deleted_cb != nullptr)
+            awaiter->deleted_cb(a);
+        // LVGL may be walking its animation list or deleting an object:
+        // resume outside of it
+        lv_async_call(AnimationAwaiter::resume_cb, handle.address());
+    }
+
+    void AnimationAwaiter::resume_cb(void * address) {
+        std::coroutine_handle<>::from_address(address).resume();
+    }
+
+    void AnimationAwaiter::await_suspend(std::coroutine_handle<> handle) {
+        // deleted_cb is called both when the animation ends and when it
+        // gets deleted; LVGL copies the descriptor on start, so ours only
+        // go to the running copy and the animation is restored afterwards
+        auto a = this->anim.raw_ptr();
+        this->handle = handle;
+        this->deleted_cb = a->deleted_cb;
+        this->user_data = a->user_data;
+        lv_anim_set_deleted_cb(a, AnimationAwaiter::deleted_trampoline);
+        lv_anim_set_user_data(a, static_cast<void*>(this));
+        this->anim.start();
+        lv_anim_set_deleted_cb(a, this->deleted_cb);
+        lv_anim_set_user_data(a, this->user_data);
+    }
+
+    EventAwaiter::EventAwaiter(core::Object & obj, lv_event_code_t filter) : obj(obj.raw_ptr()), filter(filter) {}
+
+    void EventAwaiter::event_cb(lv_event_t * e) {
+        auto awaiter = static_cast<EventAwaiter*>(lv_event_get_user_data(e));
+        auto code = lv_event_get_code(e);
+        if (code == LV_EVENT_DELETE)
+            awaiter->deleted = true;
+        if (awaiter->fired) return;
+        if (code == awaiter->filter || code == LV_EVENT_DELETE) {
+            // removing an event callback while LVGL iterates over them
+            // would skip the next one: finish outside of event processing
+            awaiter->fired = true;
+            awaiter->code = code;
+            lv_async_call(EventAwaiter::resume_cb, static_cast<void*>(awaiter));
+        }
+    }
+
+    void EventAwaiter::resume_cb(void * self) {
+        auto awaiter = static_cast<EventAwaiter*>(self);
+        if (!awaiter->deleted)
+            lv_obj_remove_event_cb_with_user_data(awaiter->obj, EventAwaiter::event_cb, self);
+        awaiter->handle.resume();
+    }
+
+    void EventAwaiter::await_suspend(std::coroutine_handle<> handle) {
+        this->handle = handle;
+        lv_obj_add_event_cb(this->obj, EventAwaiter::event_cb, LV_EVENT_ALL, static_cast<void*>(this));
+    }
+
+}
+#endif // __cplusplus >= 202002L && LV_USE_USER_DATA
@@ -0,0 +1,353 @@
+/** \file coro.h
+ *  \brief Header file for C++20 coroutines scheduled by LVGL.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include "../lv_wrapper.h"
+
+// coroutines need C++20; awaitables store the coroutine handle as user_data
+#if __cplusplus >= 202002L && LV_USE_USER_DATA
+#include <coroutine>
+
+/** \def LVGLPP_CORO_FRAME_SIZE
+ *  \brief Size of a pooled coroutine frame, in bytes.
+ */
+#ifndef LVGLPP_CORO_FRAME_SIZE
+#define LVGLPP_CORO_FRAME_SIZE 512
+#endif
+
+/** \def LVGLPP_CORO_FRAME_COUNT
+ *  \brief Number of pooled coroutine frames.
+ */
+#ifndef LVGLPP_CORO_FRAME_COUNT
+#define LVGLPP_CORO_FRAME_COUNT 16
+#endif
+
+namespace lvgl::core {
+    class Object;
+}
+
+namespace lvgl::misc {
+
+    class Animation;
+
+    /** \class FramePool
+     *  \brief Fixed pool of coroutine frames. Frames larger than
+     *  LVGLPP_CORO_FRAME_SIZE, or requested while the pool is exhausted,
+     *  are allocated with lv_mem_alloc and counted as overflows.
+     *  The pool must only be used from the LVGL thread.
+     */
+    class FramePool {
+    public:
+        /** \fn static void * allocate(size_t size)
+         *  \brief Allocates a frame.
+         *  \param size: frame size, in bytes.
+         *  \returns pointer to frame.
+         */
+        static void * allocate(size_t size);
+
+        /** \fn static void deallocate(void * frame)
+         *  \brief Frees a frame.
+         *  \param frame: pointer to frame.
+         */
+        static void deallocate(void * frame);
+
+        /** \fn static uint32_t get_used()
+         *  \brief Gets the number of pooled frames in use.
+         *  \returns number of frames.
+         */
+        static uint32_t get_used();
+
+        /** \fn static uint32_t get_overflows()
+         *  \brief Gets the number of frames allocated outside of the pool.
+         *  \returns number of frames.
+         */
+        static uint32_t get_overflows();
+    };
+
+    /** \class Task
+     *  \brief Coroutine running on the LVGL thread. A task starts as soon as
+     *  it is called and runs until its first suspension. It can be awaited
+     *  by another task; otherwise, it keeps running after the Task object
+     *  is discarded and frees its frame on completion.
+     */
+    class Task {
+    public:
+        /** \struct promise_type
+         *  \brief Coroutine promise.
+         */
+        struct promise_type {
+            /** \property std::coroutine_handle<> continuation
+             *  \brief Coroutine awaiting this task.
+             */
+            std::coroutine_handle<> continuation;
+
+            /** \property bool detached
+             *  \brief If true, no Task object refers to this coroutine anymore.
+             */
+            bool detached = false;
+
+            /** \struct FinalAwaiter
+             *  \brief Resumes awaiting coroutine on completion, and frees
+             *  detached coroutines.
+             */
+            struct FinalAwaiter {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                    auto & promise = handle.promise();
+                    auto next = promise.continuation ? promise.continuation : std::noop_coroutine();
+                    if (promise.detached)
+                        handle.destroy();
+                    return next;
+                }
+                void await_resume() noexcept {}
+            };
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+
+            static void * operator new(size_t size) { return FramePool::allocate(size); }
+            static void operator delete(void * frame) { FramePool::deallocate(frame); }
+        };
+
+    private:
+        /** \property std::coroutine_handle<promise_type> handle
+         *  \brief Coroutine handle.
+         */
+        std::coroutine_handle<promise_type> handle;
+
+        /** \fn explicit Task(std::coroutine_handle<promise_type> handle)
+         *  \brief Constructor.
+         *  \param handle: coroutine handle.
+         */
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    public:
+        Task(const Task &) = delete;
+        Task & operator=(const Task &) = delete;
+
+        /** \fn Task(Task && other)
+         *  \brief Move constructor.
+         *  \param other: task to move from.
+         */
+        Task(Task && other) noexcept : handle(other.handle) {
+            other.handle = nullptr;
+        }
+
+        /** \fn ~Task()
+         *  \brief Destructor. Frees a finished coroutine, or detaches a
+         *  running one.
+         */
+        ~Task() {
+            if (!this->handle) return;
+            if (this->handle.done())
+                this->handle.destroy();
+            else
+                this->handle.promise().detached = true;
+        }
+
+        /** \fn bool is_done() const
+         *  \brief Tells if the task has completed.
+         *  \returns true if completed, false otherwise.
+         */
+        bool is_done() const {
+            return !this->handle || this->handle.done();
+        }
+
+        /** \fn auto operator co_await() const
+         *  \brief Makes the task awaitable from another task.
+         *  \returns awaiter.
+         */
+        auto operator co_await() const {
+            struct Awaiter {
+                std::coroutine_handle<promise_type> handle;
+                bool await_ready() const { return !this->handle || this->handle.done(); }
+                void await_suspend(std::coroutine_handle<> caller) {
+                    this->handle.promise().continuation = caller;
+                }
+                void await_resume() {}
+            };
+            return Awaiter{this->handle};
+        }
+    };
+
+    /** \class SleepAwaiter
+     *  \brief Suspends a task for a given time, with a one-shot LVGL timer.
+     */
+    class SleepAwaiter {
+    private:
+        /** \property uint32_t period
+         *  \brief Sleep duration, in ms.
+         */
+        uint32_t period;
+
+    public:
+        /** \fn SleepAwaiter(uint32_t period)
+         *  \brief Constructor.
+         *  \param period: sleep duration, in ms.
+         */
+        SleepAwaiter(uint32_t period) : period(period) {}
+
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const {}
+    };
+
+    /** \class AnimationAwaiter
+     *  \brief Starts an animation and suspends a task until the animation
+     *  ends or gets deleted. The running animation gets its own deleted
+     *  callback and user data; those set on the animation are kept, and
+     *  its deleted callback is still called. The task resumes from LVGL's
+     *  async call queue, outside of animation handling.
+     */
+    class AnimationAwaiter {
+    private:
+        /** \property Animation & anim
+         *  \brief Animation to play.
+         */
+        Animation & anim;
+
+        /** \property std::coroutine_handle<> handle
+         *  \brief Suspended task.
+         */
+        std::coroutine_handle<> handle;
+
+        /** \property lv_anim_deleted_cb_t deleted_cb
+         *  \brief Deleted callback set on the animation.
+         */
+        lv_anim_deleted_cb_t deleted_cb = nullptr;
+
+        /** \property void * user_data
+         *  \brief User data set on the animation.
+         */
+        void * user_data = nullptr;
+
+        /** \fn static void deleted_trampoline(lv_anim_t * a)
+         *  \brief Deleted callback of the running animation. Calls the
+         *  animation's own deleted callback, then schedules task resumption.
+         *  \param a: running animation; user data points to awaiter.
+         */
+        static void deleted_trampoline(lv_anim_t * a);
+
+        /** \fn static void resume_cb(void * address)
+         *  \brief Async call resuming task.
+         *  \param address: coroutine handle address.
+         */
+        static void resume_cb(void * address);
+
+    public:
+        /** \fn AnimationAwaiter(Animation & anim)
+         *  \brief Constructor.
+         *  \param anim: animation to play.
+         */
+        AnimationAwaiter(Animation & anim) : anim(anim) {}
+
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const {}
+    };
+
+    /** \class EventAwaiter
+     *  \brief Suspends a task until an object receives an event of given
+     *  type, or gets deleted. The task resumes from LVGL's async call queue,
+     *  outside of event processing.
+     */
+    class EventAwaiter {
+    private:
+        /** \property lv_obj_t * obj
+         *  \brief Object to listen to.
+         */
+        lv_obj_t * obj;
+
+        /** \property lv_event_code_t filter
+         *  \brief Awaited event code.
+         */
+        lv_event_code_t filter;
+
+        /** \property lv_event_code_t code
+         *  \brief Received event code.
+         */
+        lv_event_code_t code = LV_EVENT_ALL;
+
+        /** \property bool fired
+         *  \brief If true, task resumption is scheduled.
+         */
+        bool fired = false;
+
+        /** \property bool deleted
+         *  \brief If true, object got deleted.
+         */
+        bool deleted = false;
+
+        /** \property std::coroutine_handle<> handle
+         *  \brief Awaiting coroutine.
+         */
+        std::coroutine_handle<> handle;
+
+        /** \fn static void event_cb(lv_event_t * e)
+         *  \brief Event callback.
+         *  \param e: event.
+         */
+        static void event_cb(lv_event_t * e);
+
+        /** \fn static void resume_cb(void * self)
+         *  \brief Async call removing event callback and resuming task.
+         *  \param self: pointer to awaiter.
+         */
+        static void resume_cb(void * self);
+
+    public:
+        /** \fn EventAwaiter(core::Object & obj, lv_event_code_t filter)
+         *  \brief Constructor.
+         *  \param obj: object to listen to.
+         *  \param filter: awaited event code.
+         */
+        EventAwaiter(core::Object & obj, lv_event_code_t filter);
+
+        bool await_ready() const { return false; }
+        void await_suspend(std::coroutine_handle<> handle);
+
+        /** \fn lv_event_code_t await_resume() const
+         *  \brief Gets received event.
+         *  \returns event code; LV_EVENT_DELETE if object got deleted.
+         */
+        lv_event_code_t await_resume() const { return this->code; }
+    };
+
+    /** \fn inline SleepAwaiter sleep_for(uint32_t period)
+     *  \brief Suspends current task for given time.
+     *  \param period: duration, in ms.
+     *  \returns awaitable.
+     */
+    inline SleepAwaiter sleep_for(uint32_t period) {
+        return SleepAwaiter(period);
+    }
+
+    /** \fn inline AnimationAwaiter play(Animation & anim)
+     *  \brief Starts an animation and suspends current task until it ends.
+     *  \param anim: animation to play.
+     *  \returns awaitable.
+     */
+    inline AnimationAwaiter play(Animation & anim) {
+        return AnimationAwaiter(anim);
+    }
+
+    /** \fn inline EventAwaiter next_event(core::Object & obj, lv_event_code_t filter)
+     *  \brief Suspends current task until object receives given event.
+     *  \param obj: object to listen to.
+     *  \param filter: awaited event code.
+     *  \returns awaitable.
+     */
+    inline EventAwaiter next_event(core::Object & obj, lv_event_code_t filter) {
+        return EventAwaiter(obj, filter);
+    }
+
+}
+#endif // __cplusplus >= 202002L && LV_USE_USER_DATA
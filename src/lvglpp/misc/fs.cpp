@@ -4,7 +4,10 @@
  *  Author: Vincent Paeder
  *  License: MIT
  */
+#include <algorithm>
+#include <cstring>
 #include "fs.h"
+#include "fstrace.h"
 
 // we need user_data to store pointer to C++ object, otherwise we cannot
 // access callbacks defined as class members.
@@ -20,54 +23,50 @@ namespace lvgl::misc {
         this->lv_obj->user_data = static_cast<void*>(this);
         // define callbacks
         auto f_ready = [] (lv_cls_ptr drv) -> bool {
-            LV_LOG_INFO("calling ready callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->ready_cb();
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Ready, nullptr, obj->ready_cb());
         };
         auto f_open = [](lv_cls_ptr drv, const char * path, lv_fs_mode_t mode) -> void* {
-            LV_LOG_INFO("calling open callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->open_cb(path, mode);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Open, nullptr,
+                obj->is_cached() ? obj->cached_open(path, mode) : obj->open_cb(path, mode));
         };
         auto f_close = [](lv_cls_ptr drv, void * file_p) -> lv_fs_res_t {
-            LV_LOG_INFO("calling close callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->close_cb(file_p);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Close, nullptr,
+                obj->is_cached() ? obj->cached_close(file_p) : obj->close_cb(file_p));
         };
         auto f_read = [](lv_cls_ptr drv, void * file_p, void * buf, uint32_t btr, uint32_t * br) -> lv_fs_res_t {
-            LV_LOG_INFO("calling read callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->read_cb(file_p, buf, btr, br);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Read, br,
+                obj->is_cached() ? obj->cached_read(file_p, buf, btr, br) : obj->read_cb(file_p, buf, btr, br));
         };
         auto f_write = [](lv_cls_ptr drv, void * file_p, const void * buf, uint32_t btw, uint32_t * bw) -> lv_fs_res_t {
-            LV_LOG_INFO("calling write callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->write_cb(file_p, buf, btw, bw);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Write, bw,
+                obj->is_cached() ? obj->cached_write(file_p, buf, btw, bw) : obj->write_cb(file_p, buf, btw, bw));
         };
         auto f_seek = [](lv_cls_ptr drv, void * file_p, uint32_t pos, lv_fs_whence_t whence) -> lv_fs_res_t {
-            LV_LOG_INFO("calling seek callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->seek_cb(file_p, pos, whence);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Seek, nullptr,
+                obj->is_cached() ? obj->cached_seek(file_p, pos, whence) : obj->seek_cb(file_p, pos, whence));
         };
         auto f_tell = [](lv_cls_ptr drv, void * file_p, uint32_t * pos_p) -> lv_fs_res_t {
-            LV_LOG_INFO("calling tell callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->tell_cb(file_p, pos_p);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, Tell, nullptr,
+                obj->is_cached() ? obj->cached_tell(file_p, pos_p) : obj->tell_cb(file_p, pos_p));
         };
         auto f_dir_open = [](lv_cls_ptr drv, const char * path) -> void* {
-            LV_LOG_INFO("calling dir open callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->dir_open_cb(path);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, DirOpen, nullptr, obj->dir_open_cb(path));
         };
         auto f_dir_read = [](lv_cls_ptr drv, void * rddir_p, char * fn) -> lv_fs_res_t {
-            LV_LOG_INFO("calling dir read callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->dir_read_cb(rddir_p, fn);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, DirRead, nullptr, obj->dir_read_cb(rddir_p, fn));
         };
         auto f_dir_close = [](lv_cls_ptr drv, void * rddir_p) -> lv_fs_res_t {
-            LV_LOG_INFO("calling dir close callback.");
             auto obj = reinterpret_cast<FileSystem*>(drv->user_data);
-            return obj->dir_close_cb(rddir_p);
+            return LVGLPP_FS_TRACE_CALL(drv->letter, DirClose, nullptr, obj->dir_close_cb(rddir_p));
         };
         this->lv_obj->ready_cb = f_ready;
         this->lv_obj->open_cb = f_open;
@@ -103,6 +102,194 @@ namespace lvgl::misc {
     }
 
 
+    void FileSystem::set_cache(uint32_t block_count, uint32_t block_size, uint32_t read_ahead) {
+        if (block_size == 0) block_count = 0;
+        this->block_size = block_size;
+        this->read_ahead = std::min(read_ahead, block_count > 0 ? block_count - 1 : 0);
+        this->cache_blocks.assign(block_count, CacheBlock());
+        this->cache_data.assign(static_cast<size_t>(block_count) * block_size, 0);
+        this->staging.assign(block_count > 0 ? static_cast<size_t>(this->read_ahead + 1) * block_size : 0, 0);
+        this->cache_blocks.shrink_to_fit();
+        this->cache_data.shrink_to_fit();
+        this->staging.shrink_to_fit();
+    }
+
+    const FileSystem::CacheStats & FileSystem::get_cache_stats() const {
+        return this->stats;
+    }
+
+    void FileSystem::reset_cache_stats() {
+        this->stats = CacheStats();
+    }
+
+    bool FileSystem::is_cached() const {
+        return !this->cache_blocks.empty();
+    }
+
+    void FileSystem::invalidate(const CachedFile * file) {
+        for (auto & block : this->cache_blocks)
+            if (block.file == file)
+                block.file = nullptr;
+    }
+
+    lv_fs_res_t FileSystem::device_seek(CachedFile * file, uint32_t pos) {
+        if (file->device_pos == pos) return LV_FS_RES_OK;
+        this->stats.device_seeks++;
+        auto res = this->seek_cb(file->file_p, pos, LV_FS_SEEK_SET);
+        file->device_pos = res == LV_FS_RES_OK ? pos : UINT32_MAX;
+        return res;
+    }
+
+    const uint8_t * FileSystem::get_block(CachedFile * file, uint32_t index, uint32_t * len, lv_fs_res_t * res) {
+        this->stamp++;
+        *res = LV_FS_RES_OK;
+        for (size_t n=0; n<this->cache_blocks.size(); n++) {
+            auto & block = this->cache_blocks[n];
+            if (block.file == file && block.index == index) {
+                this->stats.hits++;
+                block.stamp = this->stamp;
+                *len = block.len;
+                return this->cache_data.data() + n * this->block_size;
+            }
+        }
+        this->stats.misses++;
+        // read missed block and following ones in a single call
+        *res = this->device_seek(file, index * this->block_size);
+        if (*res != LV_FS_RES_OK) return nullptr;
+        uint32_t nr = 0;
+        this->stats.device_reads++;
+        *res = this->read_cb(file->file_p, this->staging.data(), this->staging.size(), &nr);
+        if (*res != LV_FS_RES_OK) {
+            file->device_pos = UINT32_MAX;
+            return nullptr;
+        }
+        file->device_pos += nr;
+        this->stats.device_bytes += nr;
+        // store blocks in least recently used slots; a short last block
+        // marks the end of file, so it is kept too
+        const uint8_t * first = nullptr;
+        for (uint32_t b=0; b<=this->read_ahead; b++) {
+            uint32_t offset = b * this->block_size;
+            if (b > 0 && offset >= nr) break;
+            size_t slot = 0;
+            for (size_t n=1; n<this->cache_blocks.size(); n++)
+                if (this->cache_blocks[n].file == nullptr
+                    || (this->cache_blocks[slot].file != nullptr && this->cache_blocks[n].stamp < this->cache_blocks[slot].stamp))
+                    slot = n;
+            auto & block = this->cache_blocks[slot];
+            block.file = file;
+            block.index = index + b;
+            block.len = std::min(nr - std::min(nr, offset), this->block_size);
+            // requested block gets the newest stamp, read-ahead ones older
+            block.stamp = b == 0 ? this->stamp : this->stamp - 1;
+            auto data = this->cache_data.data() + slot * this->block_size;
+            std::memcpy(data, this->staging.data() + offset, block.len);
+            if (b == 0) {
+                first = data;
+                *len = block.len;
+            }
+        }
+        return first;
+    }
+
+    void * FileSystem::cached_open(const char * path, lv_fs_mode_t mode) {
+        auto file_p = this->open_cb(path, mode);
+        if (file_p == nullptr) return nullptr;
+        return static_cast<void*>(new CachedFile{file_p, 0, 0});
+    }
+
+    lv_fs_res_t FileSystem::cached_close(void * file_p) {
+        auto file = static_cast<CachedFile*>(file_p);
+        this->invalidate(file);
+        auto res = this->close_cb(file->file_p);
+        delete file;
+        return res;
+    }
+
+    lv_fs_res_t FileSystem::cached_read(void * file_p, void * buf, uint32_t btr, uint32_t * br) {
+        auto file = static_cast<CachedFile*>(file_p);
+        auto dst = static_cast<uint8_t*>(buf);
+        lv_fs_res_t res = LV_FS_RES_OK;
+        uint32_t done = 0;
+        while (done < btr) {
+            uint32_t index = file->pos / this->block_size;
+            uint32_t offset = file->pos % this->block_size;
+            // block-aligned reads larger than the read buffer go straight to the driver
+            if (offset == 0 && btr - done >= this->staging.size()) {
+                uint32_t n = (btr - done) / this->block_size * this->block_size;
+                res = this->device_seek(file, file->pos);
+                if (res != LV_FS_RES_OK) break;
+                uint32_t nr = 0;
+                this->stats.device_reads++;
+                res = this->read_cb(file->file_p, dst + done, n, &nr);
+                if (res != LV_FS_RES_OK) {
+                    file->device_pos = UINT32_MAX;
+                    break;
+                }
+                file->device_pos += nr;
+                file->pos += nr;
+                done += nr;
+                this->stats.device_bytes += nr;
+                if (nr < n) break;
+                continue;
+            }
+            uint32_t len = 0;
+            auto data = this->get_block(file, index, &len, &res);
+            if (data == nullptr || offset >= len) break;
+            uint32_t n = std::min(btr - done, len - offset);
+            std::memcpy(dst + done, data + offset, n);
+            file->pos += n;
+            done += n;
+            if (len < this->block_size && offset + n >= len) break;
+        }
+        this->stats.bytes_read += done;
+        if (br != nullptr) *br = done;
+        return res;
+    }
+
+    lv_fs_res_t FileSystem::cached_write(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) {
+        auto file = static_cast<CachedFile*>(file_p);
+        this->invalidate(file);
+        auto res = this->device_seek(file, file->pos);
+        if (res != LV_FS_RES_OK) return res;
+        uint32_t nw = 0;
+        res = this->write_cb(file->file_p, buf, btw, &nw);
+        file->pos += nw;
+        file->device_pos = res == LV_FS_RES_OK ? file->pos : UINT32_MAX;
+        if (bw != nullptr) *bw = nw;
+        return res;
+    }
+
+    lv_fs_res_t FileSystem::cached_seek(void * file_p, uint32_t pos, lv_fs_whence_t whence) {
+        auto file = static_cast<CachedFile*>(file_p);
+        switch (whence) {
+            case LV_FS_SEEK_SET:
+                file->pos = pos;
+                return LV_FS_RES_OK;
+            case LV_FS_SEEK_CUR:
+                file->pos += pos;
+                return LV_FS_RES_OK;
+            default: {
+                // the file size is only known to the driver
+                this->stats.device_seeks++;
+                auto res = this->seek_cb(file->file_p, pos, whence);
+                if (res != LV_FS_RES_OK) {
+                    file->device_pos = UINT32_MAX;
+                    return res;
+                }
+                res = this->tell_cb(file->file_p, &file->pos);
+                file->device_pos = res == LV_FS_RES_OK ? file->pos : UINT32_MAX;
+                return res;
+            }
+        }
+    }
+
+    lv_fs_res_t FileSystem::cached_tell(void * file_p, uint32_t * pos_p) {
+        *pos_p = static_cast<CachedFile*>(file_p)->pos;
+        return LV_FS_RES_OK;
+    }
+
+
     std::string get_filesystem_letters() {
         std::string buf(26,'\0');
         lv_fs_get_letters(&buf[0]);
@@ -126,16 +313,28 @@ namespace lvgl::misc {
 
     std::string File::read(uint32_t btr) {
         std::string buf(btr, '\0');
-        uint32_t nr;
+        uint32_t nr = 0;
         auto res = lv_fs_read(this->raw_ptr(), reinterpret_cast<void*>(&buf[0]), btr, &nr);
         if (res != LV_FS_RES_OK) return std::string{};
+        buf.resize(nr);
         return buf;
     }
 
+    uint32_t File::read_into(void * buf, uint32_t btr, lv_fs_res_t * res) {
+        uint32_t nr = 0;
+        auto r = lv_fs_read(this->raw_ptr(), buf, btr, &nr);
+        if (res != nullptr) *res = r;
+        return nr;
+    }
+
     uint32_t File::write(const std::string & data) {
-        uint32_t bw;
-        lv_fs_write(this->raw_ptr(),
-                    reinterpret_cast<const void*>(data.c_str()), data.size(), &bw);
+        return this->write(reinterpret_cast<const void*>(data.c_str()), data.size());
+    }
+
+    uint32_t File::write(const void * buf, uint32_t btw, lv_fs_res_t * res) {
+        uint32_t bw = 0;
+        auto r = lv_fs_write(this->raw_ptr(), buf, btw, &bw);
+        if (res != nullptr) *res = r;
         return bw;
     }
 
@@ -151,6 +350,86 @@ namespace lvgl::misc {
     }
 
 
+    FileReader::FileReader(File & file, uint32_t buffer_size) : file(file), buffer(buffer_size > 0 ? buffer_size : 1) {}
+
+    bool FileReader::fill() {
+        if (this->pos < this->len) return true;
+        if (this->end) return false;
+        this->pos = 0;
+        this->len = this->file.read_into(this->buffer.data(), this->buffer.size(), &this->res);
+        if (this->res != LV_FS_RES_OK || this->len < this->buffer.size())
+            this->end = true;
+        return this->len > 0;
+    }
+
+    uint32_t FileReader::read(void * buf, uint32_t btr) {
+        auto dst = static_cast<uint8_t*>(buf);
+        uint32_t done = 0;
+        // drain buffered data first
+        uint32_t n = std::min(btr, this->len - this->pos);
+        std::memcpy(dst, this->buffer.data() + this->pos, n);
+        this->pos += n;
+        done += n;
+        // large remainders bypass the buffer
+        if (btr - done >= this->buffer.size() && !this->end) {
+            auto nr = this->file.read_into(dst + done, btr - done, &this->res);
+            if (this->res != LV_FS_RES_OK || nr < btr - done)
+                this->end = true;
+            return done + nr;
+        }
+        while (done < btr && this->fill()) {
+            n = std::min(btr - done, this->len - this->pos);
+            std::memcpy(dst + done, this->buffer.data() + this->pos, n);
+            this->pos += n;
+            done += n;
+        }
+        return done;
+    }
+
+    std::string_view FileReader::read_chunk(uint32_t max) {
+        if (!this->fill()) return std::string_view{};
+        uint32_t n = std::min(max, this->len - this->pos);
+        auto view = std::string_view(reinterpret_cast<const char*>(this->buffer.data() + this->pos), n);
+        this->pos += n;
+        return view;
+    }
+
+    bool FileReader::read_line(std::string & line, char delim) {
+        line.clear();
+        bool got_data = false;
+        while (this->fill()) {
+            got_data = true;
+            auto start = this->buffer.data() + this->pos;
+            auto found = static_cast<const uint8_t*>(std::memchr(start, delim, this->len - this->pos));
+            if (found != nullptr) {
+                line.append(reinterpret_cast<const char*>(start), found - start);
+                this->pos += (found - start) + 1;
+                return true;
+            }
+            line.append(reinterpret_cast<const char*>(start), this->len - this->pos);
+            this->pos = this->len;
+        }
+        return got_data;
+    }
+
+    lv_fs_res_t FileReader::skip(uint32_t count) {
+        uint32_t n = std::min(count, this->len - this->pos);
+        this->pos += n;
+        count -= n;
+        if (count == 0 || this->end) return this->res;
+        this->res = this->file.seek(count, LV_FS_SEEK_CUR);
+        return this->res;
+    }
+
+    bool FileReader::is_eof() const {
+        return this->end && this->pos >= this->len;
+    }
+
+    lv_fs_res_t FileReader::get_result() const {
+        return this->res;
+    }
+
+
     Directory::Directory() {
         this->lv_obj = LvPointerType(lv_cls_alloc<lv_cls>());
     }
@@ -171,5 +450,34 @@ namespace lvgl::misc {
         return res;
     }
 
+    bool Directory::read(Entry & entry) {
+        if (lv_fs_dir_read(this->raw_ptr(), this->name_buf) != LV_FS_RES_OK || this->name_buf[0] == '\0')
+            return false;
+        // drivers mark directories with a leading slash
+        entry.is_dir = this->name_buf[0] == '/';
+        auto name = this->name_buf + (entry.is_dir ? 1 : 0);
+        auto last = std::find(name, this->name_buf + sizeof(this->name_buf), '\0');
+        entry.name = std::string_view(name, last - name);
+        return true;
+    }
+
+    Directory::Iterator Directory::begin() {
+        return Iterator(this);
+    }
+
+    Directory::Iterator Directory::end() {
+        return Iterator();
+    }
+
+    Directory::Iterator::Iterator(Directory * dir) : dir(dir) {
+        ++(*this);
+    }
+
+    Directory::Iterator & Directory::Iterator::operator++() {
+        if (this->dir != nullptr && !this->dir->read(this->entry))
+            this->dir = nullptr;
+        return *this;
+    }
+
 }
 #endif // LV_USE_USER_DATA
\ No newline at end of file
@@ -5,6 +5,10 @@
  *  License: MIT
  */
 #pragma once
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 #include "../lv_wrapper.h"
 
 // we need user_data to store pointer to C++ object, otherwise we cannot
@@ -21,7 +25,184 @@ namespace lvgl::misc {
      *  file system drivers for LVGL.
      */
     class FileSystem : public PointerWrapper<lv_fs_drv_t, lv_mem_free> {
+    public:
+        /** \struct CacheStats
+         *  \brief Block cache statistics.
+         */
+        struct CacheStats {
+            /** \property uint32_t hits
+             *  \brief Number of blocks served from cache.
+             */
+            uint32_t hits = 0;
+
+            /** \property uint32_t misses
+             *  \brief Number of blocks fetched from driver.
+             */
+            uint32_t misses = 0;
+
+            /** \property uint64_t bytes_read
+             *  \brief Number of bytes returned to LVGL.
+             */
+            uint64_t bytes_read = 0;
+
+            /** \property uint64_t device_bytes
+             *  \brief Number of bytes read from driver.
+             */
+            uint64_t device_bytes = 0;
+
+            /** \property uint32_t device_reads
+             *  \brief Number of driver read calls.
+             */
+            uint32_t device_reads = 0;
+
+            /** \property uint32_t device_seeks
+             *  \brief Number of driver seek calls.
+             */
+            uint32_t device_seeks = 0;
+        };
+
+    private:
+        /** \struct CachedFile
+         *  \brief File handle given to LVGL when cache is enabled.
+         */
+        struct CachedFile {
+            /** \property void * file_p
+             *  \brief File descriptor returned by driver.
+             */
+            void * file_p;
+
+            /** \property uint32_t pos
+             *  \brief Position seen by LVGL.
+             */
+            uint32_t pos;
+
+            /** \property uint32_t device_pos
+             *  \brief Position of driver access pointer.
+             */
+            uint32_t device_pos;
+        };
+
+        /** \struct CacheBlock
+         *  \brief Cached file block.
+         */
+        struct CacheBlock {
+            /** \property const CachedFile * file
+             *  \brief File the block belongs to; nullptr if unused.
+             */
+            const CachedFile * file = nullptr;
+
+            /** \property uint32_t index
+             *  \brief Block index within file.
+             */
+            uint32_t index = 0;
+
+            /** \property uint32_t len
+             *  \brief Number of valid bytes; less than block size at end of file.
+             */
+            uint32_t len = 0;
+
+            /** \property uint32_t stamp
+             *  \brief Last access stamp, for LRU eviction.
+             */
+            uint32_t stamp = 0;
+        };
+
+        /** \property std::vector<CacheBlock> cache_blocks
+         *  \brief Cache block table.
+         */
+        std::vector<CacheBlock> cache_blocks;
+
+        /** \property std::vector<uint8_t> cache_data
+         *  \brief Cache block contents.
+         */
+        std::vector<uint8_t> cache_data;
+
+        /** \property std::vector<uint8_t> staging
+         *  \brief Buffer for driver reads, including read-ahead blocks.
+         */
+        std::vector<uint8_t> staging;
+
+        /** \property uint32_t block_size
+         *  \brief Cache block size, in bytes.
+         */
+        uint32_t block_size = 0;
+
+        /** \property uint32_t read_ahead
+         *  \brief Number of blocks read after a missed one.
+         */
+        uint32_t read_ahead = 0;
+
+        /** \property uint32_t stamp
+         *  \brief Access counter.
+         */
+        uint32_t stamp = 0;
+
+        /** \property CacheStats stats
+         *  \brief Cache statistics.
+         */
+        CacheStats stats;
+
+        /** \fn const uint8_t * get_block(CachedFile * file, uint32_t index, uint32_t * len, lv_fs_res_t * res)
+         *  \brief Gets a block from cache, reading it (and following ones) from driver if missing.
+         *  \param file: cached file.
+         *  \param index: block index.
+         *  \param len: receives number of valid bytes in block.
+         *  \param res: receives result code.
+         *  \returns pointer to block data, or nullptr if failed.
+         */
+        const uint8_t * get_block(CachedFile * file, uint32_t index, uint32_t * len, lv_fs_res_t * res);
+
+        /** \fn lv_fs_res_t device_seek(CachedFile * file, uint32_t pos)
+         *  \brief Moves driver access pointer, if not already in place.
+         *  \param file: cached file.
+         *  \param pos: absolute position.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t device_seek(CachedFile * file, uint32_t pos);
+
+        /** \fn void invalidate(const CachedFile * file)
+         *  \brief Drops cached blocks of a file.
+         *  \param file: cached file.
+         */
+        void invalidate(const CachedFile * file);
+
+        /** \fn void * cached_open(const char * path, lv_fs_mode_t mode)
+         *  \brief Opens a file through cache.
+         */
+        void * cached_open(const char * path, lv_fs_mode_t mode);
+
+        /** \fn lv_fs_res_t cached_close(void * file_p)
+         *  \brief Closes a file opened through cache.
+         */
+        lv_fs_res_t cached_close(void * file_p);
+
+        /** \fn lv_fs_res_t cached_read(void * file_p, void * buf, uint32_t btr, uint32_t * br)
+         *  \brief Reads from a file through cache.
+         */
+        lv_fs_res_t cached_read(void * file_p, void * buf, uint32_t btr, uint32_t * br);
+
+        /** \fn lv_fs_res_t cached_write(void * file_p, const void * buf, uint32_t btw, uint32_t * bw)
+         *  \brief Writes to a file opened through cache.
+         */
+        lv_fs_res_t cached_write(void * file_p, const void * buf, uint32_t btw, uint32_t * bw);
+
+        /** \fn lv_fs_res_t cached_seek(void * file_p, uint32_t pos, lv_fs_whence_t whence)
+         *  \brief Moves access pointer of a file opened through cache.
+         */
+        lv_fs_res_t cached_seek(void * file_p, uint32_t pos, lv_fs_whence_t whence);
+
+        /** \fn lv_fs_res_t cached_tell(void * file_p, uint32_t * pos_p)
+         *  \brief Gets access pointer of a file opened through cache.
+         */
+        lv_fs_res_t cached_tell(void * file_p, uint32_t * pos_p);
+
     protected:
+        /** \fn bool is_cached() const
+         *  \brief Tells if block cache is enabled.
+         *  \returns true if enabled, false otherwise.
+         */
+        bool is_cached() const;
+
         /** \fn virtual bool ready_cb()
          *  \brief Tells if the file system is ready to use.
          *  \returns true if file system is ready, false otherwise.
@@ -132,6 +313,29 @@ namespace lvgl::misc {
          *  \returns true if file system is ready, false otherwise.
          */
         bool is_ready() const;
+
+        /** \fn void set_cache(uint32_t block_count, uint32_t block_size = 512, uint32_t read_ahead = 1)
+         *  \brief Enables a block cache in front of the driver callbacks. Reads
+         *  are served from cached blocks; a missed block is read together with
+         *  the following read_ahead blocks in a single driver call. Least
+         *  recently used blocks get evicted. Must not be called while files
+         *  are open.
+         *  \param block_count: number of cached blocks; 0 disables cache.
+         *  \param block_size: block size, in bytes.
+         *  \param read_ahead: number of blocks read after a missed one.
+         */
+        void set_cache(uint32_t block_count, uint32_t block_size = 512, uint32_t read_ahead = 1);
+
+        /** \fn const CacheStats & get_cache_stats() const
+         *  \brief Gets block cache statistics.
+         *  \returns cache statistics.
+         */
+        const CacheStats & get_cache_stats() const;
+
+        /** \fn void reset_cache_stats()
+         *  \brief Resets block cache statistics.
+         */
+        void reset_cache_stats();
     };
 
     /** \fn std::string get_filesystem_letters()
@@ -166,10 +370,32 @@ namespace lvgl::misc {
 
         /** \fn std::string read(uint32_t btr)
          *  \brief Reads a number of bytes from file.
-         *  \returns bytes read, or an empty string if failed.
+         *  \returns bytes read (possibly fewer than requested), or an empty
+         *  string if failed.
          */
         std::string read(uint32_t btr);
 
+        /** \fn uint32_t read_into(void * buf, uint32_t btr, lv_fs_res_t * res = nullptr)
+         *  \brief Reads a number of bytes from file into a caller buffer.
+         *  \param buf: recipient buffer, at least btr bytes long.
+         *  \param btr: number of bytes to read.
+         *  \param res: if not null, receives result code.
+         *  \returns number of bytes read, including when reading fails midway.
+         */
+        uint32_t read_into(void * buf, uint32_t btr, lv_fs_res_t * res = nullptr);
+
+        /** \fn template <class T> uint32_t read_into(T & buf, lv_fs_res_t * res = nullptr)
+         *  \brief Fills a contiguous container (array, vector, string, ...) from file.
+         *  \tparam T: container type.
+         *  \param buf: recipient container; its size sets the amount to read.
+         *  \param res: if not null, receives result code.
+         *  \returns number of bytes read.
+         */
+        template <class T> uint32_t read_into(T & buf, lv_fs_res_t * res = nullptr) {
+            return this->read_into(static_cast<void*>(std::data(buf)),
+                                   std::size(buf) * sizeof(*std::data(buf)), res);
+        }
+
         /** \fn uint32_t write(const std::string & data)
          *  \brief Writes data to file.
          *  \param data: data to write.
@@ -177,6 +403,30 @@ namespace lvgl::misc {
          */
         uint32_t write(const std::string & data);
 
+        /** \fn uint32_t write(const void * buf, uint32_t btw, lv_fs_res_t * res = nullptr)
+         *  \brief Writes data from a caller buffer to file.
+         *  \param buf: data to write.
+         *  \param btw: number of bytes to write.
+         *  \param res: if not null, receives result code.
+         *  \returns number of bytes written.
+         */
+        uint32_t write(const void * buf, uint32_t btw, lv_fs_res_t * res = nullptr);
+
+        /** \fn template <class T> uint32_t write(const T & data, lv_fs_res_t * res = nullptr)
+         *  \brief Writes the content of a contiguous container (array, vector,
+         *  string_view, ...) to file. Strings and character arrays go through
+         *  the std::string overload.
+         *  \tparam T: container type.
+         *  \param data: data to write.
+         *  \param res: if not null, receives result code.
+         *  \returns number of bytes written.
+         */
+        template <class T, class = std::enable_if_t<!std::is_convertible_v<const T &, std::string>>>
+        uint32_t write(const T & data, lv_fs_res_t * res = nullptr) {
+            return this->write(static_cast<const void*>(std::data(data)),
+                               std::size(data) * sizeof(*std::data(data)), res);
+        }
+
         /** \fn lv_fs_res_t seek(uint32_t pos, lv_fs_whence_t whence)
          *  \brief Moves access pointer to given position.
          *  \param pos: position to move to.
@@ -193,10 +443,195 @@ namespace lvgl::misc {
     };
 
 
+    /** \class FileReader
+     *  \brief Buffered reader over a File. Small reads are served from one
+     *  internal buffer, allocated once; reads larger than the buffer go
+     *  directly to the caller buffer.
+     */
+    class FileReader {
+    private:
+        /** \property File & file
+         *  \brief File to read from.
+         */
+        File & file;
+
+        /** \property std::vector<uint8_t> buffer
+         *  \brief Read buffer.
+         */
+        std::vector<uint8_t> buffer;
+
+        /** \property uint32_t pos
+         *  \brief Read position in buffer.
+         */
+        uint32_t pos = 0;
+
+        /** \property uint32_t len
+         *  \brief Number of valid bytes in buffer.
+         */
+        uint32_t len = 0;
+
+        /** \property lv_fs_res_t res
+         *  \brief Result of last file operation.
+         */
+        lv_fs_res_t res = LV_FS_RES_OK;
+
+        /** \property bool end
+         *  \brief If true, end of file has been reached.
+         */
+        bool end = false;
+
+        /** \fn bool fill()
+         *  \brief Refills buffer from file if empty.
+         *  \returns true if buffer has data, false otherwise.
+         */
+        bool fill();
+
+    public:
+        /** \fn FileReader(File & file, uint32_t buffer_size = 512)
+         *  \brief Constructor.
+         *  \param file: file to read from. Must remain open while reading.
+         *  \param buffer_size: size of read buffer, in bytes.
+         */
+        FileReader(File & file, uint32_t buffer_size = 512);
+
+        /** \fn uint32_t read(void * buf, uint32_t btr)
+         *  \brief Reads a number of bytes.
+         *  \param buf: recipient buffer.
+         *  \param btr: number of bytes to read.
+         *  \returns number of bytes read.
+         */
+        uint32_t read(void * buf, uint32_t btr);
+
+        /** \fn std::string_view read_chunk(uint32_t max)
+         *  \brief Reads up to max bytes without copying. The view is valid
+         *  until next read.
+         *  \param max: maximum number of bytes.
+         *  \returns view into read buffer; empty at end of file or on error.
+         */
+        std::string_view read_chunk(uint32_t max);
+
+        /** \fn bool read_line(std::string & line, char delim = '\n')
+         *  \brief Reads until delimiter, which is consumed but not stored.
+         *  \param line: recipient string; its capacity is reused.
+         *  \param delim: delimiter character.
+         *  \returns true if something was read, false at end of file.
+         */
+        bool read_line(std::string & line, char delim = '\n');
+
+        /** \fn lv_fs_res_t skip(uint32_t count)
+         *  \brief Skips a number of bytes.
+         *  \param count: number of bytes to skip.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t skip(uint32_t count);
+
+        /** \fn bool is_eof() const
+         *  \brief Tells if all data has been consumed.
+         *  \returns true if end of file is reached and buffer is empty.
+         */
+        bool is_eof() const;
+
+        /** \fn lv_fs_res_t get_result() const
+         *  \brief Gets result of last file operation.
+         *  \returns result code: LV_FS_RES_OK if successful, LV_RES_* otherwise.
+         */
+        lv_fs_res_t get_result() const;
+    };
+
+
     /** \class Directory
      *  \brief Wraps a lv_fs_dir_t object.
      */
     class Directory : public PointerWrapper<lv_fs_dir_t, lv_mem_free> {
+    public:
+        /** \struct Entry
+         *  \brief Directory entry. Name points into the directory buffer and
+         *  is only valid until the next entry is read.
+         */
+        struct Entry {
+            /** \property std::string_view name
+             *  \brief Entry name, without directory marker.
+             */
+            std::string_view name;
+
+            /** \property bool is_dir
+             *  \brief If true, entry is a directory.
+             */
+            bool is_dir = false;
+        };
+
+        /** \class Iterator
+         *  \brief Input iterator over directory entries.
+         */
+        class Iterator {
+        private:
+            /** \property Directory * dir
+             *  \brief Directory being read, or nullptr at end.
+             */
+            Directory * dir = nullptr;
+
+            /** \property Entry entry
+             *  \brief Current entry.
+             */
+            Entry entry;
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Entry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Entry*;
+            using reference = const Entry&;
+
+            /** \fn Iterator()
+             *  \brief Constructor for end iterator.
+             */
+            Iterator() = default;
+
+            /** \fn Iterator(Directory * dir)
+             *  \brief Constructor. Reads first entry.
+             *  \param dir: directory to read.
+             */
+            Iterator(Directory * dir);
+
+            /** \fn reference operator*() const
+             *  \brief Gets current entry.
+             *  \returns current entry.
+             */
+            reference operator*() const { return this->entry; }
+
+            /** \fn pointer operator->() const
+             *  \brief Accesses current entry.
+             *  \returns pointer to current entry.
+             */
+            pointer operator->() const { return &this->entry; }
+
+            /** \fn Iterator & operator++()
+             *  \brief Reads next entry.
+             *  \returns this iterator.
+             */
+            Iterator & operator++();
+
+            /** \fn bool operator==(const Iterator & other) const
+             *  \brief Compares iterators. Only end position is meaningful.
+             *  \param other: other iterator.
+             *  \returns true if both iterators are at the same position.
+             */
+            bool operator==(const Iterator & other) const { return this->dir == other.dir; }
+
+            /** \fn bool operator!=(const Iterator & other) const
+             *  \brief Compares iterators. Only end position is meaningful.
+             *  \param other: other iterator.
+             *  \returns true if iterators are at different positions.
+             */
+            bool operator!=(const Iterator & other) const { return this->dir != other.dir; }
+        };
+
+    private:
+        /** \property char name_buf[256]
+         *  \brief Entry name buffer, reused for every entry.
+         */
+        char name_buf[256];
+
     public:
         using PointerWrapper::PointerWrapper;
 
@@ -221,6 +656,26 @@ namespace lvgl::misc {
          *  \returns path to next entry, or empty string if failed.
          */
         std::string read();
+
+        /** \fn bool read(Entry & entry)
+         *  \brief Reads next entry in directory without allocating.
+         *  \param entry: receives entry; its name is valid until next read.
+         *  \returns true if an entry was read, false at end or if failed.
+         */
+        bool read(Entry & entry);
+
+        /** \fn Iterator begin()
+         *  \brief Gets iterator on first entry not read yet. Directory
+         *  can only be traversed once.
+         *  \returns iterator.
+         */
+        Iterator begin();
+
+        /** \fn Iterator end()
+         *  \brief Gets end iterator.
+         *  \returns iterator.
+         */
+        Iterator end();
         
     };
 
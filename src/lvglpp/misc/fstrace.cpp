@@ -0,0 +1,70 @@
+/** \file fstrace.cpp
+ *  \brief Implementation file for file system call tracing.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include "fstrace.h"
+
+#if LVGLPP_FS_TRACE
+#include <chrono>
+
+namespace lvgl::misc {
+
+    static FsTrace::Record records[LVGLPP_FS_TRACE_SIZE];
+    static uint32_t record_count = 0;
+    static FsTrace::Stats stats[FsTrace::OpCount];
+
+    static const char * op_names[FsTrace::OpCount] = {
+        "ready", "open", "close", "read", "write", "seek", "tell", "dir_open", "dir_read", "dir_close"
+    };
+
+    uint32_t FsTrace::now() {
+        auto t = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(t).count());
+    }
+
+    void FsTrace::record(char letter, Op op, uint32_t start, uint32_t bytes, lv_fs_res_t res) {
+        uint32_t duration = now() - start;
+        records[record_count % LVGLPP_FS_TRACE_SIZE] = Record{start, duration, bytes, letter, op, res};
+        record_count++;
+        auto & s = stats[op];
+        s.calls++;
+        if (res != LV_FS_RES_OK) s.errors++;
+        s.bytes += bytes;
+        s.total_time += duration;
+        if (duration > s.max_time) s.max_time = duration;
+    }
+
+    const FsTrace::Stats & FsTrace::get_stats(Op op) {
+        return stats[op];
+    }
+
+    std::vector<FsTrace::Record> FsTrace::get_records() {
+        std::vector<Record> res;
+        uint32_t n = record_count < LVGLPP_FS_TRACE_SIZE ? record_count : LVGLPP_FS_TRACE_SIZE;
+        res.reserve(n);
+        for (uint32_t i=record_count-n; i<record_count; i++)
+            res.push_back(records[i % LVGLPP_FS_TRACE_SIZE]);
+        return res;
+    }
+
+    void FsTrace::print() {
+        for (uint8_t op=0; op<OpCount; op++) {
+            auto & s = stats[op];
+            if (s.calls == 0) continue;
+            LV_LOG_USER("%s: %u calls, %u errors, %lu bytes, %lu us total, %lu us avg, %u us max",
+                        op_names[op], s.calls, s.errors, static_cast<unsigned long>(s.bytes),
+                        static_cast<unsigned long>(s.total_time),
+                        static_cast<unsigned long>(s.total_time / s.calls), s.max_time);
+        }
+    }
+
+    void FsTrace::reset() {
+        record_count = 0;
+        for (auto & s : stats)
+            s = Stats();
+    }
+
+}
+#endif // LVGLPP_FS_TRACE
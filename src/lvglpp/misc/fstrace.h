@@ -0,0 +1,182 @@
+/** \file fstrace.h
+ *  \brief Header file for file system call tracing.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include "../lv_wrapper.h"
+
+/** \def LVGLPP_FS_TRACE
+ *  \brief If non-zero, FileSystem callbacks are timed and recorded by
+ *  FsTrace. If zero, tracing compiles to nothing.
+ */
+#ifndef LVGLPP_FS_TRACE
+#define LVGLPP_FS_TRACE 0
+#endif
+
+/** \def LVGLPP_FS_TRACE_SIZE
+ *  \brief Number of records kept in the trace ring buffer.
+ */
+#ifndef LVGLPP_FS_TRACE_SIZE
+#define LVGLPP_FS_TRACE_SIZE 256
+#endif
+
+#if LVGLPP_FS_TRACE
+#include <vector>
+
+namespace lvgl::misc {
+
+    /** \class FsTrace
+     *  \brief Records FileSystem callback calls in a ring buffer and keeps
+     *  per-operation statistics. Callbacks run on the LVGL thread, so
+     *  this isn't synchronized.
+     */
+    class FsTrace {
+    public:
+        /** \enum Op
+         *  \brief Traced operation.
+         */
+        enum Op : uint8_t {
+            Ready, Open, Close, Read, Write, Seek, Tell, DirOpen, DirRead, DirClose,
+            OpCount
+        };
+
+        /** \struct Record
+         *  \brief Single traced call.
+         */
+        struct Record {
+            /** \property uint32_t start
+             *  \brief Call time, in microseconds (wraps around).
+             */
+            uint32_t start;
+
+            /** \property uint32_t duration
+             *  \brief Call duration, in microseconds.
+             */
+            uint32_t duration;
+
+            /** \property uint32_t bytes
+             *  \brief Number of bytes transferred.
+             */
+            uint32_t bytes;
+
+            /** \property char letter
+             *  \brief Driver letter.
+             */
+            char letter;
+
+            /** \property Op op
+             *  \brief Operation.
+             */
+            Op op;
+
+            /** \property lv_fs_res_t res
+             *  \brief Result code.
+             */
+            lv_fs_res_t res;
+        };
+
+        /** \struct Stats
+         *  \brief Aggregated statistics for one operation.
+         */
+        struct Stats {
+            /** \property uint32_t calls
+             *  \brief Number of calls.
+             */
+            uint32_t calls = 0;
+
+            /** \property uint32_t errors
+             *  \brief Number of failed calls.
+             */
+            uint32_t errors = 0;
+
+            /** \property uint64_t bytes
+             *  \brief Number of bytes transferred.
+             */
+            uint64_t bytes = 0;
+
+            /** \property uint64_t total_time
+             *  \brief Cumulated duration, in microseconds.
+             */
+            uint64_t total_time = 0;
+
+            /** \property uint32_t max_time
+             *  \brief Longest call, in microseconds.
+             */
+            uint32_t max_time = 0;
+        };
+
+        /** \fn static uint32_t now()
+         *  \brief Gets current time.
+         *  \returns time, in microseconds.
+         */
+        static uint32_t now();
+
+        /** \fn static void record(char letter, Op op, uint32_t start, uint32_t bytes, lv_fs_res_t res)
+         *  \brief Records a call ending now.
+         *  \param letter: driver letter.
+         *  \param op: operation.
+         *  \param start: call start time, from now().
+         *  \param bytes: number of bytes transferred.
+         *  \param res: result code.
+         */
+        static void record(char letter, Op op, uint32_t start, uint32_t bytes, lv_fs_res_t res);
+
+        /** \fn template <class F> static auto call(char letter, Op op, const uint32_t * bytes, F && f)
+         *  \brief Calls and traces a callback.
+         *  \tparam F: callable type.
+         *  \param letter: driver letter.
+         *  \param op: operation.
+         *  \param bytes: if not null, points to number of bytes transferred,
+         *  read after the call.
+         *  \param f: callable.
+         *  \returns value returned by callable.
+         */
+        template <class F>
+        static auto call(char letter, Op op, const uint32_t * bytes, F && f) {
+            auto start = now();
+            auto ret = f();
+            record(letter, op, start, bytes != nullptr ? *bytes : 0, result_of(ret));
+            return ret;
+        }
+
+        /** \fn static const Stats & get_stats(Op op)
+         *  \brief Gets statistics for an operation.
+         *  \param op: operation.
+         *  \returns statistics.
+         */
+        static const Stats & get_stats(Op op);
+
+        /** \fn static std::vector<Record> get_records()
+         *  \brief Gets recorded calls still in ring buffer, oldest first.
+         *  \returns recorded calls.
+         */
+        static std::vector<Record> get_records();
+
+        /** \fn static void print()
+         *  \brief Logs statistics of every operation with LV_LOG_USER.
+         */
+        static void print();
+
+        /** \fn static void reset()
+         *  \brief Clears records and statistics.
+         */
+        static void reset();
+
+    private:
+        static lv_fs_res_t result_of(lv_fs_res_t res) { return res; }
+        static lv_fs_res_t result_of(void * file_p) { return file_p != nullptr ? LV_FS_RES_OK : LV_FS_RES_UNKNOWN; }
+        static lv_fs_res_t result_of(bool ready) { return ready ? LV_FS_RES_OK : LV_FS_RES_NOT_EX; }
+    };
+
+}
+
+/** \def LVGLPP_FS_TRACE_CALL(letter, op, bytes, expr)
+ *  \brief Evaluates expr, tracing it when LVGLPP_FS_TRACE is enabled.
+ */
+#define LVGLPP_FS_TRACE_CALL(letter, op, bytes, expr) \
+    ::lvgl::misc::FsTrace::call((letter), ::lvgl::misc::FsTrace::op, (bytes), [&]() { return (expr); })
+#else
+#define LVGLPP_FS_TRACE_CALL(letter, op, bytes, expr) (expr)
+#endif // LVGLPP_FS_TRACE
@@ -0,0 +1,189 @@
+/** \file mmapfs.cpp
+ *  \brief Implementation file for a memory-mapped POSIX file system driver.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include "mmapfs.h"
+
+// FileSystem requires user_data; mapping relies on POSIX mmap
+#if LV_USE_USER_DATA && defined(__linux__)
+#include <algorithm>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lvgl::misc {
+
+    MappedFileSystem::MappedFileSystem(char letter, const std::string & root) : FileSystem(letter), root(root) {}
+
+    MappedFileSystem::~MappedFileSystem() {
+        for (auto & m : this->mappings)
+            if (m.second.data != nullptr)
+                munmap(const_cast<uint8_t*>(m.second.data), m.second.size);
+    }
+
+    bool MappedFileSystem::map_file(const std::string & path, const uint8_t ** data, size_t * size) const {
+        auto full_path = this->root + path;
+        int fd = ::open(full_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return false;
+        }
+        *size = static_cast<size_t>(st.st_size);
+        *data = nullptr;
+        if (*size > 0) {
+            // the mapping stays valid after the descriptor is closed
+            auto p = mmap(nullptr, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            *data = static_cast<const uint8_t*>(p);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    bool MappedFileSystem::ready_cb() {
+        return true;
+    }
+
+    void * MappedFileSystem::open_cb(const char * path, lv_fs_mode_t mode) {
+        if (mode & LV_FS_MODE_WR) return nullptr;
+        auto it = this->mappings.find(path);
+        if (it != this->mappings.end())
+            return static_cast<void*>(new OpenFile{it->second.data, it->second.size, 0, true});
+        const uint8_t * data;
+        size_t size;
+        if (!this->map_file(path, &data, &size)) return nullptr;
+        return static_cast<void*>(new OpenFile{data, size, 0, false});
+    }
+
+    lv_fs_res_t MappedFileSystem::close_cb(void * file_p) {
+        auto file = static_cast<OpenFile*>(file_p);
+        if (!file->persistent && file->data != nullptr)
+            munmap(const_cast<uint8_t*>(file->data), file->size);
+        delete file;
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t MappedFileSystem::read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) {
+        auto file = static_cast<OpenFile*>(file_p);
+        auto n = static_cast<uint32_t>(std::min<size_t>(btr, file->size - std::min(file->pos, file->size)));
+        if (n > 0)
+            std::memcpy(buf, file->data + file->pos, n);
+        file->pos += n;
+        *br = n;
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t MappedFileSystem::write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) {
+        *bw = 0;
+        return LV_FS_RES_DENIED;
+    }
+
+    lv_fs_res_t MappedFileSystem::seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) {
+        auto file = static_cast<OpenFile*>(file_p);
+        switch (whence) {
+            case LV_FS_SEEK_SET:
+                file->pos = pos;
+                break;
+            case LV_FS_SEEK_CUR:
+                file->pos += pos;
+                break;
+            case LV_FS_SEEK_END:
+                file->pos = file->size + pos;
+                break;
+            default:
+                return LV_FS_RES_INV_PARAM;
+        }
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t MappedFileSystem::tell_cb(void * file_p, uint32_t * pos_p) {
+        *pos_p = static_cast<uint32_t>(static_cast<OpenFile*>(file_p)->pos);
+        return LV_FS_RES_OK;
+    }
+
+    void * MappedFileSystem::dir_open_cb(const char * path) {
+        auto full_path = this->root + path;
+        return static_cast<void*>(opendir(full_path.c_str()));
+    }
+
+    lv_fs_res_t MappedFileSystem::dir_read_cb(void * rddir_p, char * fn) {
+        auto dir = static_cast<DIR*>(rddir_p);
+        struct dirent * entry;
+        do {
+            entry = readdir(dir);
+        } while (entry != nullptr && (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0));
+        if (entry == nullptr) {
+            // LVGL signals the end of a directory with an empty name
+            fn[0] = '\0';
+            return LV_FS_RES_OK;
+        }
+        // LVGL marks directories with a leading slash; names are limited to 256 bytes
+        if (entry->d_type == DT_DIR) {
+            fn[0] = '/';
+            std::strncpy(fn + 1, entry->d_name, 254);
+        } else {
+            std::strncpy(fn, entry->d_name, 255);
+        }
+        fn[255] = '\0';
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t MappedFileSystem::dir_close_cb(void * rddir_p) {
+        closedir(static_cast<DIR*>(rddir_p));
+        return LV_FS_RES_OK;
+    }
+
+    const uint8_t * MappedFileSystem::map(const std::string & path, size_t * size) {
+        auto it = this->mappings.find(path);
+        if (it == this->mappings.end()) {
+            Mapping m;
+            std::memset(&m, 0, sizeof(Mapping));
+            if (!this->map_file(path, &m.data, &m.size)) return nullptr;
+            it = this->mappings.emplace(path, m).first;
+        }
+        if (size != nullptr) *size = it->second.size;
+        return it->second.data;
+    }
+
+    draw::ImageDescriptor MappedFileSystem::map_image(const std::string & path) {
+        size_t size;
+        auto data = this->map(path, &size);
+        if (data == nullptr || size < sizeof(lv_img_header_t))
+            return draw::ImageDescriptor();
+        auto & image = this->mappings[path].image;
+        std::memcpy(&image.header, data, sizeof(lv_img_header_t));
+        image.data = data + sizeof(lv_img_header_t);
+        image.data_size = static_cast<uint32_t>(size - sizeof(lv_img_header_t));
+        // the descriptor belongs to the mapping: don't let the wrapper free it
+        return draw::ImageDescriptor(&image, false);
+    }
+
+    bool MappedFileSystem::unmap(const std::string & path) {
+        auto it = this->mappings.find(path);
+        if (it == this->mappings.end()) return false;
+        if (it->second.data != nullptr)
+            munmap(const_cast<uint8_t*>(it->second.data), it->second.size);
+        this->mappings.erase(it);
+        return true;
+    }
+
+    const uint8_t * MappedFileSystem::get_data(const File & file, uint32_t * size) const {
+        auto f = file.raw_ptr();
+        if (f->drv != this->raw_ptr() || f->file_d == nullptr || this->is_cached()) return nullptr;
+        auto open_file = static_cast<const OpenFile*>(f->file_d);
+        if (size != nullptr) *size = static_cast<uint32_t>(open_file->size);
+        return open_file->data;
+    }
+
+}
+#endif // LV_USE_USER_DATA && defined(__linux__)
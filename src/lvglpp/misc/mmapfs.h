@@ -0,0 +1,150 @@
+/** \file mmapfs.h
+ *  \brief Header file for a memory-mapped POSIX file system driver.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <unordered_map>
+#include "fs.h"
+#include "../draw/image.h"
+
+// FileSystem requires user_data; mapping relies on POSIX mmap
+#if LV_USE_USER_DATA && defined(__linux__)
+
+namespace lvgl::misc {
+
+    /** \class MappedFileSystem
+     *  \brief Read-only file system driver mapping files in memory. Reads
+     *  are copies from the mapping, without system calls. Files can also
+     *  be mapped persistently, in which case LVGL image descriptors can
+     *  point directly into the mapping and later opens reuse it.
+     *  The block cache (set_cache) brings nothing here and prevents
+     *  get_data from working.
+     */
+    class MappedFileSystem : public FileSystem {
+    private:
+        /** \struct Mapping
+         *  \brief Persistent file mapping.
+         */
+        struct Mapping {
+            /** \property const uint8_t * data
+             *  \brief Mapped file content.
+             */
+            const uint8_t * data;
+
+            /** \property size_t size
+             *  \brief File size, in bytes.
+             */
+            size_t size;
+
+            /** \property lv_img_dsc_t image
+             *  \brief Image descriptor pointing into mapping.
+             */
+            lv_img_dsc_t image;
+        };
+
+        /** \struct OpenFile
+         *  \brief Open file descriptor.
+         */
+        struct OpenFile {
+            /** \property const uint8_t * data
+             *  \brief Mapped file content.
+             */
+            const uint8_t * data;
+
+            /** \property size_t size
+             *  \brief File size, in bytes.
+             */
+            size_t size;
+
+            /** \property size_t pos
+             *  \brief Access pointer position.
+             */
+            size_t pos;
+
+            /** \property bool persistent
+             *  \brief If true, mapping outlives the file.
+             */
+            bool persistent;
+        };
+
+        /** \property std::string root
+         *  \brief Directory prepended to paths.
+         */
+        std::string root;
+
+        /** \property std::unordered_map<std::string, Mapping> mappings
+         *  \brief Persistent mappings, by path.
+         */
+        std::unordered_map<std::string, Mapping> mappings;
+
+        /** \fn bool map_file(const std::string & path, const uint8_t ** data, size_t * size) const
+         *  \brief Maps a file in memory.
+         *  \param path: path relative to root.
+         *  \param data: receives pointer to mapping.
+         *  \param size: receives file size.
+         *  \returns true if successful, false otherwise.
+         */
+        bool map_file(const std::string & path, const uint8_t ** data, size_t * size) const;
+
+    protected:
+        bool ready_cb() override;
+        void * open_cb(const char * path, lv_fs_mode_t mode) override;
+        lv_fs_res_t close_cb(void * file_p) override;
+        lv_fs_res_t read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) override;
+        lv_fs_res_t write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) override;
+        lv_fs_res_t seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) override;
+        lv_fs_res_t tell_cb(void * file_p, uint32_t * pos_p) override;
+        void * dir_open_cb(const char * path) override;
+        lv_fs_res_t dir_read_cb(void * rddir_p, char * fn) override;
+        lv_fs_res_t dir_close_cb(void * rddir_p) override;
+
+    public:
+        /** \fn MappedFileSystem(char letter, const std::string & root = "")
+         *  \brief Constructor.
+         *  \param letter: registration letter for LVGL.
+         *  \param root: directory prepended to paths.
+         */
+        MappedFileSystem(char letter, const std::string & root = "");
+
+        /** \fn ~MappedFileSystem()
+         *  \brief Destructor. Unmaps persistent mappings.
+         */
+        ~MappedFileSystem();
+
+        /** \fn const uint8_t * map(const std::string & path, size_t * size = nullptr)
+         *  \brief Maps a file persistently.
+         *  \param path: file path, without drive letter.
+         *  \param size: if not null, receives file size.
+         *  \returns pointer to file content, or nullptr if failed.
+         */
+        const uint8_t * map(const std::string & path, size_t * size = nullptr);
+
+        /** \fn draw::ImageDescriptor map_image(const std::string & path)
+         *  \brief Maps a LVGL binary image file (lv_img_header_t followed by
+         *  pixel data) and gets a descriptor pointing into the mapping. The
+         *  descriptor remains valid until the file gets unmapped.
+         *  \param path: file path, without drive letter.
+         *  \returns image descriptor; empty (no data) if failed.
+         */
+        draw::ImageDescriptor map_image(const std::string & path);
+
+        /** \fn bool unmap(const std::string & path)
+         *  \brief Releases a persistent mapping. Files opened from it must be closed.
+         *  \param path: file path, without drive letter.
+         *  \returns true if file was mapped, false otherwise.
+         */
+        bool unmap(const std::string & path);
+
+        /** \fn const uint8_t * get_data(const File & file, uint32_t * size = nullptr) const
+         *  \brief Gets a direct pointer to the content of an open file.
+         *  \param file: file opened through this file system.
+         *  \param size: if not null, receives file size.
+         *  \returns pointer to file content, or nullptr if not available.
+         */
+        const uint8_t * get_data(const File & file, uint32_t * size = nullptr) const;
+    };
+
+}
+#endif // LV_USE_USER_DATA && defined(__linux__)
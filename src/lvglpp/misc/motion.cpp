@@ -0,0 +1,210 @@
+/** \file motion.cpp
+ *  \brief Implementation file for physics-based motion driven by a LVGL timer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <cstdlib>
+#include "motion.h"
+
+// Timer requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    // 16.16 fixed-point helpers
+    static constexpr int32_t fx_one = 1 << 16;
+    // time step in seconds, as 16.16 fixed-point
+    static constexpr int64_t fx_dt = (static_cast<int64_t>(MotionEngine::step) << 16) / 1000;
+    // a spring settles when within half a unit of its rest position...
+    static constexpr int32_t rest_distance = fx_one / 2;
+    // ...and slower than 4 units per second
+    static constexpr int32_t rest_velocity = 4 * fx_one;
+    // a decay motion stops below 1 unit per second
+    static constexpr int32_t stop_velocity = fx_one;
+    // longest time simulated per timer call, in ms; avoids catching up
+    // for ages after a stall
+    static constexpr uint32_t max_lag = 100;
+
+    // velocity limit, 2^24 units per second: well beyond any real motion,
+    // and low enough that spring forces can't overflow 64 bits
+    static constexpr int64_t max_velocity = static_cast<int64_t>(1) << 40;
+
+    // positions are limited to what 16.16 fixed-point holds in 32 bits
+    static inline int32_t to_fixed(int32_t v) {
+        return std::clamp<int32_t>(v, INT16_MIN, INT16_MAX) * fx_one;
+    }
+
+    static inline int32_t from_fixed(int64_t v) {
+        return static_cast<int32_t>((v + fx_one / 2) >> 16);
+    }
+
+    static inline int32_t clamp_position(int64_t v) {
+        return static_cast<int32_t>(std::clamp<int64_t>(v, INT32_MIN, INT32_MAX));
+    }
+
+    static inline int64_t clamp_velocity(int64_t v) {
+        return std::clamp(v, -max_velocity, max_velocity);
+    }
+
+    static inline int64_t velocity_to_fixed(int32_t v) {
+        return clamp_velocity(static_cast<int64_t>(v) * fx_one);
+    }
+
+    MotionEngine::MotionEngine(uint32_t capacity, uint32_t period) : Timer(period) {
+        this->bodies.resize(capacity);
+        this->free_list.reserve(capacity);
+        for (uint32_t n=capacity; n>0; n--) {
+            this->bodies[n-1].mode = Mode::Free;
+            this->free_list.push_back(n-1);
+        }
+        this->pause();
+    }
+
+    void MotionEngine::set_mode(Body & body, Mode mode) {
+        bool was_moving = body.mode == Mode::Spring || body.mode == Mode::Decay;
+        bool is_moving = mode == Mode::Spring || mode == Mode::Decay;
+        body.mode = mode;
+        if (was_moving == is_moving) return;
+        if (is_moving) {
+            if (this->active++ == 0) {
+                this->last_tick = lv_tick_get();
+                this->lag = 0;
+                this->resume();
+            }
+        } else if (--this->active == 0) {
+            this->pause();
+        }
+    }
+
+    void MotionEngine::output(Body & body) {
+        auto value = from_fixed(body.position);
+        if (value != body.last_value) {
+            body.last_value = value;
+            body.setter(body.target, value);
+        }
+    }
+
+    void MotionEngine::integrate(Body & body) {
+        // semi-implicit Euler: update velocity first, then position
+        if (body.mode == Mode::Spring) {
+            int64_t dx = static_cast<int64_t>(body.position) - body.rest_position;
+            int64_t accel = -body.spring.stiffness * dx - body.spring.damping * body.velocity;
+            body.velocity = clamp_velocity(body.velocity + ((accel * fx_dt) >> 16));
+            body.position = clamp_position(body.position + ((body.velocity * fx_dt) >> 16));
+            dx = static_cast<int64_t>(body.position) - body.rest_position;
+            if (std::abs(dx) < rest_distance && std::abs(body.velocity) < rest_velocity) {
+                body.position = body.rest_position;
+                body.velocity = 0;
+                this->set_mode(body, Mode::Rest);
+            }
+        } else if (body.mode == Mode::Decay) {
+            int64_t decel = body.friction * body.velocity;
+            body.velocity = clamp_velocity(body.velocity - ((decel * fx_dt) >> 16));
+            body.position = clamp_position(body.position + ((body.velocity * fx_dt) >> 16));
+            if (body.position < to_fixed(body.min) || body.position > to_fixed(body.max)) {
+                // out of bounds: spring back to nearest bound
+                body.rest_position = to_fixed(body.position < to_fixed(body.min) ? body.min : body.max);
+                this->set_mode(body, Mode::Spring);
+            } else if (std::abs(body.velocity) < stop_velocity) {
+                body.velocity = 0;
+                this->set_mode(body, Mode::Rest);
+            }
+        }
+    }
+
+    void MotionEngine::callback(Timer & timer) {
+        uint32_t now = lv_tick_get();
+        this->lag = std::min(this->lag + (now - this->last_tick), max_lag);
+        this->last_tick = now;
+        uint32_t steps = this->lag / step;
+        this->lag -= steps * step;
+        if (steps == 0) return;
+        for (auto & body : this->bodies) {
+            if (body.mode != Mode::Spring && body.mode != Mode::Decay) continue;
+            for (uint32_t n=0; n<steps && (body.mode == Mode::Spring || body.mode == Mode::Decay); n++)
+                this->integrate(body);
+            this->output(body);
+        }
+    }
+
+    MotionEngine::Handle MotionEngine::add(void * target, lv_anim_exec_xcb_t setter, int32_t position) {
+        if (this->free_list.empty()) return invalid;
+        auto handle = this->free_list.back();
+        this->free_list.pop_back();
+        auto & body = this->bodies[handle];
+        body.target = target;
+        body.setter = setter;
+        body.position = to_fixed(position);
+        body.velocity = 0;
+        body.rest_position = body.position;
+        body.spring = SpringParams();
+        body.friction = 0;
+        body.min = INT16_MIN;
+        body.max = INT16_MAX;
+        body.last_value = position;
+        body.mode = Mode::Rest;
+        return handle;
+    }
+
+    void MotionEngine::remove(Handle body) {
+        this->set_mode(this->bodies[body], Mode::Free);
+        this->free_list.push_back(body);
+    }
+
+    void MotionEngine::spring_to(Handle body, int32_t position, const SpringParams & params) {
+        auto & b = this->bodies[body];
+        b.rest_position = to_fixed(position);
+        b.spring = params;
+        this->set_mode(b, Mode::Spring);
+    }
+
+    void MotionEngine::fling(Handle body, int32_t velocity, int32_t friction, int32_t min, int32_t max,
+                             const SpringParams & params) {
+        auto & b = this->bodies[body];
+        b.velocity = velocity_to_fixed(velocity);
+        b.friction = friction;
+        b.min = min;
+        b.max = max;
+        b.spring = params;
+        this->set_mode(b, Mode::Decay);
+    }
+
+    void MotionEngine::set_position(Handle body, int32_t position) {
+        auto & b = this->bodies[body];
+        b.position = to_fixed(position);
+        b.velocity = 0;
+        this->set_mode(b, Mode::Rest);
+        this->output(b);
+    }
+
+    void MotionEngine::set_velocity(Handle body, int32_t velocity) {
+        this->bodies[body].velocity = velocity_to_fixed(velocity);
+    }
+
+    void MotionEngine::stop(Handle body) {
+        auto & b = this->bodies[body];
+        b.velocity = 0;
+        this->set_mode(b, Mode::Rest);
+    }
+
+    int32_t MotionEngine::get_position(Handle body) const {
+        return from_fixed(this->bodies[body].position);
+    }
+
+    int32_t MotionEngine::get_velocity(Handle body) const {
+        return from_fixed(this->bodies[body].velocity);
+    }
+
+    bool MotionEngine::is_moving(Handle body) const {
+        auto mode = this->bodies[body].mode;
+        return mode == Mode::Spring || mode == Mode::Decay;
+    }
+
+    uint32_t MotionEngine::get_active_count() const {
+        return this->active;
+    }
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,275 @@
+/** \file motion.h
+ *  \brief Header file for physics-based motion driven by a LVGL timer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <vector>
+#include "timer.h"
+
+// Timer requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    /** \struct SpringParams
+     *  \brief Spring parameters, for a unit mass.
+     */
+    struct SpringParams {
+        /** \property int32_t stiffness
+         *  \brief Spring constant, in 1/s^2.
+         */
+        int32_t stiffness = 170;
+
+        /** \property int32_t damping
+         *  \brief Damping coefficient, in 1/s.
+         */
+        int32_t damping = 26;
+    };
+
+    /** \class MotionEngine
+     *  \brief Simulates spring and decay (fling) motions with a single timer.
+     * 
+     *  Bodies are allocated from a pool sized at construction; starting,
+     *  retargeting or stopping a motion never allocates. Integration uses
+     *  16.16 fixed-point values and fixed time steps, which keeps it cheap
+     *  on MCUs without FPU. Positions and velocities carry over when a body
+     *  gets retargeted, so motions stay continuous. The timer is paused when
+     *  all bodies are at rest.
+     */
+    class MotionEngine : public Timer {
+    public:
+        /** \typedef Handle
+         *  \brief Body identifier.
+         */
+        using Handle = uint32_t;
+
+        /** \property static constexpr Handle invalid
+         *  \brief Value returned when no body is available.
+         */
+        static constexpr Handle invalid = UINT32_MAX;
+
+        /** \property static constexpr uint32_t step
+         *  \brief Integration time step, in ms.
+         */
+        static constexpr uint32_t step = 4;
+
+    private:
+        /** \enum Mode
+         *  \brief Kind of motion a body follows.
+         */
+        enum class Mode : uint8_t { Free, Rest, Spring, Decay };
+
+        /** \struct Body
+         *  \brief State of a moving body.
+         */
+        struct Body {
+            /** \property void * target
+             *  \brief Animated variable.
+             */
+            void * target;
+
+            /** \property lv_anim_exec_xcb_t setter
+             *  \brief Function used to set variable.
+             */
+            lv_anim_exec_xcb_t setter;
+
+            /** \property int32_t position
+             *  \brief Position, in 16.16 fixed-point units.
+             */
+            int32_t position;
+
+            /** \property int64_t velocity
+             *  \brief Velocity, in 16.16 fixed-point units per second. Kept
+             *  on 64 bits, as fast motions exceed 32767 units per second.
+             */
+            int64_t velocity;
+
+            /** \property int32_t rest_position
+             *  \brief Spring rest position, in 16.16 fixed-point units.
+             */
+            int32_t rest_position;
+
+            /** \property SpringParams spring
+             *  \brief Spring parameters.
+             */
+            SpringParams spring;
+
+            /** \property int32_t friction
+             *  \brief Decay friction coefficient, in 1/s.
+             */
+            int32_t friction;
+
+            /** \property int32_t min
+             *  \brief Lower bound for decay motion.
+             */
+            int32_t min;
+
+            /** \property int32_t max
+             *  \brief Upper bound for decay motion.
+             */
+            int32_t max;
+
+            /** \property int32_t last_value
+             *  \brief Last value passed to setter.
+             */
+            int32_t last_value;
+
+            /** \property Mode mode
+             *  \brief Current motion.
+             */
+            Mode mode;
+        };
+
+        /** \property std::vector<Body> bodies
+         *  \brief Body pool.
+         */
+        std::vector<Body> bodies;
+
+        /** \property std::vector<Handle> free_list
+         *  \brief Unused bodies.
+         */
+        std::vector<Handle> free_list;
+
+        /** \property uint32_t active
+         *  \brief Number of moving bodies.
+         */
+        uint32_t active = 0;
+
+        /** \property uint32_t last_tick
+         *  \brief Tick at which simulation was last advanced.
+         */
+        uint32_t last_tick = 0;
+
+        /** \property uint32_t lag
+         *  \brief Elapsed time not yet simulated, in ms.
+         */
+        uint32_t lag = 0;
+
+        /** \fn void integrate(Body & body)
+         *  \brief Advances a body by one time step.
+         *  \param body: body to advance.
+         */
+        void integrate(Body & body);
+
+        /** \fn void set_mode(Body & body, Mode mode)
+         *  \brief Changes body motion, keeping track of moving bodies.
+         *  \param body: body to change.
+         *  \param mode: new motion.
+         */
+        void set_mode(Body & body, Mode mode);
+
+        /** \fn void output(Body & body)
+         *  \brief Calls body setter if its rounded position changed.
+         *  \param body: body to output.
+         */
+        void output(Body & body);
+
+    public:
+        /** \fn MotionEngine(uint32_t capacity, uint32_t period = LV_DISP_DEF_REFR_PERIOD)
+         *  \brief Constructor.
+         *  \param capacity: maximum number of bodies.
+         *  \param period: timer period, in ms.
+         */
+        MotionEngine(uint32_t capacity, uint32_t period = LV_DISP_DEF_REFR_PERIOD);
+
+        // the timer holds a pointer to this instance: no copy or move
+        MotionEngine(const MotionEngine &) = delete;
+        MotionEngine & operator=(const MotionEngine &) = delete;
+        MotionEngine(MotionEngine &&) = delete;
+        MotionEngine & operator=(MotionEngine &&) = delete;
+
+        /** \fn void callback(Timer & timer) override
+         *  \brief Advances simulation by the time elapsed since last call.
+         *  \param timer: timer instance.
+         */
+        void callback(Timer & timer) override;
+
+        /** \fn Handle add(void * target, lv_anim_exec_xcb_t setter, int32_t position)
+         *  \brief Takes a body from the pool. The body is at rest.
+         *  \param target: pointer to animated variable. Must remain allocated.
+         *  \param setter: function used to set variable.
+         *  \param position: initial position.
+         *  \returns body handle, or invalid if pool is exhausted.
+         */
+        Handle add(void * target, lv_anim_exec_xcb_t setter, int32_t position);
+
+        /** \fn void remove(Handle body)
+         *  \brief Stops a body and returns it to the pool.
+         *  \param body: body handle.
+         */
+        void remove(Handle body);
+
+        /** \fn void spring_to(Handle body, int32_t position, const SpringParams & params = SpringParams())
+         *  \brief Starts or retargets a spring motion. Current velocity is kept.
+         *  \param body: body handle.
+         *  \param position: rest position.
+         *  \param params: spring parameters.
+         */
+        void spring_to(Handle body, int32_t position, const SpringParams & params = SpringParams());
+
+        /** \fn void fling(Handle body, int32_t velocity, int32_t friction, int32_t min = INT16_MIN, int32_t max = INT16_MAX, const SpringParams & params = SpringParams())
+         *  \brief Starts a decay motion. If the body leaves the bounds, it
+         *  springs back to the nearest bound.
+         *  \param body: body handle.
+         *  \param velocity: initial velocity, in units per second.
+         *  \param friction: friction coefficient, in 1/s; velocity decreases
+         *  by this fraction per second.
+         *  \param min: lower bound.
+         *  \param max: upper bound.
+         *  \param params: spring parameters used to come back within bounds.
+         */
+        void fling(Handle body, int32_t velocity, int32_t friction, int32_t min = INT16_MIN, int32_t max = INT16_MAX,
+                   const SpringParams & params = SpringParams());
+
+        /** \fn void set_position(Handle body, int32_t position)
+         *  \brief Moves a body immediately and stops it (e.g. while dragging).
+         *  \param body: body handle.
+         *  \param position: new position.
+         */
+        void set_position(Handle body, int32_t position);
+
+        /** \fn void set_velocity(Handle body, int32_t velocity)
+         *  \brief Sets body velocity, e.g. as measured during a drag.
+         *  \param body: body handle.
+         *  \param velocity: velocity, in units per second.
+         */
+        void set_velocity(Handle body, int32_t velocity);
+
+        /** \fn void stop(Handle body)
+         *  \brief Stops a body where it is.
+         *  \param body: body handle.
+         */
+        void stop(Handle body);
+
+        /** \fn int32_t get_position(Handle body) const
+         *  \brief Gets body position.
+         *  \param body: body handle.
+         *  \returns rounded position.
+         */
+        int32_t get_position(Handle body) const;
+
+        /** \fn int32_t get_velocity(Handle body) const
+         *  \brief Gets body velocity.
+         *  \param body: body handle.
+         *  \returns velocity, in units per second.
+         */
+        int32_t get_velocity(Handle body) const;
+
+        /** \fn bool is_moving(Handle body) const
+         *  \brief Tells if a body is moving.
+         *  \param body: body handle.
+         *  \returns true if moving, false otherwise.
+         */
+        bool is_moving(Handle body) const;
+
+        /** \fn uint32_t get_active_count() const
+         *  \brief Gets the number of moving bodies.
+         *  \returns number of moving bodies.
+         */
+        uint32_t get_active_count() const;
+    };
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,231 @@
+/** \file prefetch.cpp
+ *  \brief Implementation file for a file system driver with background prefetching.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "prefetch.h"
+
+// FileSystem requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    PrefetchFileSystem::PrefetchFileSystem(char letter, const std::string & root, size_t budget)
+        : FileSystem(letter), root(root), budget(budget) {
+        this->worker = std::thread(&PrefetchFileSystem::run, this);
+    }
+
+    PrefetchFileSystem::~PrefetchFileSystem() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+            this->queue.clear();
+        }
+        this->cond.notify_all();
+        if (this->worker.joinable())
+            this->worker.join();
+    }
+
+    void PrefetchFileSystem::run() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        while (true) {
+            this->cond.wait(lock, [this]() { return this->stopping || !this->queue.empty(); });
+            if (this->stopping) break;
+            auto path = std::move(this->queue.front());
+            this->queue.pop_front();
+            if (this->cache.count(path) > 0) continue;
+            this->loading = path;
+            // read without holding the lock, so that LVGL thread isn't blocked
+            lock.unlock();
+            auto data = this->load(path);
+            lock.lock();
+            if (data != nullptr && this->cache.count(path) == 0) {
+                this->insert(path, data);
+                this->stats.prefetched++;
+            }
+            this->loading.clear();
+            this->cond.notify_all();
+        }
+    }
+
+    PrefetchFileSystem::Data PrefetchFileSystem::load(const std::string & path) const {
+        auto full_path = this->root + path;
+        auto f = std::fopen(full_path.c_str(), "rb");
+        if (f == nullptr) return nullptr;
+        Data data;
+        if (std::fseek(f, 0, SEEK_END) == 0) {
+            auto size = std::ftell(f);
+            if (size >= 0 && std::fseek(f, 0, SEEK_SET) == 0) {
+                auto buf = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+                if (std::fread(buf->data(), 1, buf->size(), f) == buf->size())
+                    data = std::move(buf);
+            }
+        }
+        std::fclose(f);
+        return data;
+    }
+
+    void PrefetchFileSystem::insert(const std::string & path, const Data & data) {
+        if (data->size() > this->budget) return;
+        this->trim(this->budget - data->size());
+        this->cache[path] = CacheEntry{data, ++this->stamp};
+        this->stats.bytes_cached += data->size();
+    }
+
+    void PrefetchFileSystem::trim(size_t size) {
+        while (this->stats.bytes_cached > size && !this->cache.empty()) {
+            auto lru = std::min_element(this->cache.begin(), this->cache.end(),
+                                        [](const auto & a, const auto & b) { return a.second.stamp < b.second.stamp; });
+            this->stats.bytes_cached -= lru->second.data->size();
+            this->stats.evicted++;
+            this->cache.erase(lru);
+        }
+    }
+
+    bool PrefetchFileSystem::ready_cb() {
+        return true;
+    }
+
+    void * PrefetchFileSystem::open_cb(const char * path, lv_fs_mode_t mode) {
+        if (mode & LV_FS_MODE_WR) return nullptr;
+        std::string key(path);
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            // file is being prefetched: waiting is cheaper than reading it twice
+            this->cond.wait(lock, [this, &key]() { return this->loading != key; });
+            auto it = this->cache.find(key);
+            if (it != this->cache.end()) {
+                it->second.stamp = ++this->stamp;
+                this->stats.hits++;
+                return static_cast<void*>(new OpenFile{it->second.data, 0});
+            }
+            this->stats.misses++;
+        }
+        auto data = this->load(key);
+        if (data == nullptr) return nullptr;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->cache.count(key) == 0)
+                this->insert(key, data);
+        }
+        return static_cast<void*>(new OpenFile{data, 0});
+    }
+
+    lv_fs_res_t PrefetchFileSystem::close_cb(void * file_p) {
+        delete static_cast<OpenFile*>(file_p);
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) {
+        auto file = static_cast<OpenFile*>(file_p);
+        auto size = file->data->size();
+        auto n = static_cast<uint32_t>(std::min<size_t>(btr, size - std::min(file->pos, size)));
+        if (n > 0)
+            std::memcpy(buf, file->data->data() + file->pos, n);
+        file->pos += n;
+        *br = n;
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) {
+        *bw = 0;
+        return LV_FS_RES_DENIED;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) {
+        auto file = static_cast<OpenFile*>(file_p);
+        switch (whence) {
+            case LV_FS_SEEK_SET:
+                file->pos = pos;
+                break;
+            case LV_FS_SEEK_CUR:
+                file->pos += pos;
+                break;
+            case LV_FS_SEEK_END:
+                file->pos = file->data->size() + pos;
+                break;
+            default:
+                return LV_FS_RES_INV_PARAM;
+        }
+        return LV_FS_RES_OK;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::tell_cb(void * file_p, uint32_t * pos_p) {
+        *pos_p = static_cast<uint32_t>(static_cast<OpenFile*>(file_p)->pos);
+        return LV_FS_RES_OK;
+    }
+
+    void * PrefetchFileSystem::dir_open_cb(const char * path) {
+        return nullptr;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::dir_read_cb(void * rddir_p, char * fn) {
+        return LV_FS_RES_NOT_IMP;
+    }
+
+    lv_fs_res_t PrefetchFileSystem::dir_close_cb(void * rddir_p) {
+        return LV_FS_RES_NOT_IMP;
+    }
+
+    void PrefetchFileSystem::prefetch(const std::string & path) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->queue.push_back(path);
+        }
+        this->cond.notify_all();
+    }
+
+    void PrefetchFileSystem::prefetch(const std::vector<std::string> & paths) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->queue.insert(this->queue.end(), paths.begin(), paths.end());
+        }
+        this->cond.notify_all();
+    }
+
+    void PrefetchFileSystem::cancel() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->queue.clear();
+    }
+
+    bool PrefetchFileSystem::contains(const std::string & path) const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->cache.count(path) > 0;
+    }
+
+    bool PrefetchFileSystem::is_idle() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->queue.empty() && this->loading.empty();
+    }
+
+    void PrefetchFileSystem::evict(const std::string & path) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->cache.find(path);
+        if (it == this->cache.end()) return;
+        this->stats.bytes_cached -= it->second.data->size();
+        this->stats.evicted++;
+        this->cache.erase(it);
+    }
+
+    void PrefetchFileSystem::clear() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->trim(0);
+    }
+
+    void PrefetchFileSystem::set_budget(size_t budget) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->budget = budget;
+        this->trim(budget);
+    }
+
+    PrefetchFileSystem::Stats PrefetchFileSystem::get_stats() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->stats;
+    }
+
+}
+#endif // LV_USE_USER_DATA
@@ -0,0 +1,261 @@
+/** \file prefetch.h
+ *  \brief Header file for a file system driver with background prefetching.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "fs.h"
+
+// FileSystem requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    /** \class PrefetchFileSystem
+     *  \brief Read-only file system driver backed by an in-memory cache,
+     *  filled by a worker thread from a list of upcoming paths. Files are
+     *  read with C stdio on the worker thread, so LVGL is never called from
+     *  it. Opening a cached file serves it from memory; other files are
+     *  loaded synchronously and cached. The cache has a byte budget, with
+     *  least recently used files evicted first. Files stay valid while
+     *  open, even once evicted.
+     */
+    class PrefetchFileSystem : public FileSystem {
+    public:
+        /** \struct Stats
+         *  \brief Prefetch cache statistics.
+         */
+        struct Stats {
+            /** \property uint32_t hits
+             *  \brief Number of opens served from memory.
+             */
+            uint32_t hits = 0;
+
+            /** \property uint32_t misses
+             *  \brief Number of opens loaded synchronously.
+             */
+            uint32_t misses = 0;
+
+            /** \property uint32_t prefetched
+             *  \brief Number of files loaded by worker thread.
+             */
+            uint32_t prefetched = 0;
+
+            /** \property uint32_t evicted
+             *  \brief Number of files evicted from cache.
+             */
+            uint32_t evicted = 0;
+
+            /** \property size_t bytes_cached
+             *  \brief Number of bytes currently cached.
+             */
+            size_t bytes_cached = 0;
+        };
+
+    private:
+        /** \typedef Data
+         *  \brief Shared file content.
+         */
+        using Data = std::shared_ptr<const std::vector<uint8_t>>;
+
+        /** \struct CacheEntry
+         *  \brief Cached file.
+         */
+        struct CacheEntry {
+            /** \property Data data
+             *  \brief File content.
+             */
+            Data data;
+
+            /** \property uint64_t stamp
+             *  \brief Last use stamp, for LRU eviction.
+             */
+            uint64_t stamp;
+        };
+
+        /** \struct OpenFile
+         *  \brief Open file descriptor.
+         */
+        struct OpenFile {
+            /** \property Data data
+             *  \brief File content.
+             */
+            Data data;
+
+            /** \property size_t pos
+             *  \brief Access pointer position.
+             */
+            size_t pos;
+        };
+
+        /** \property std::string root
+         *  \brief Directory prepended to paths.
+         */
+        std::string root;
+
+        /** \property std::unordered_map<std::string, CacheEntry> cache
+         *  \brief Cached files, by path.
+         */
+        std::unordered_map<std::string, CacheEntry> cache;
+
+        /** \property std::deque<std::string> queue
+         *  \brief Paths waiting to be prefetched.
+         */
+        std::deque<std::string> queue;
+
+        /** \property std::string loading
+         *  \brief Path being loaded by worker thread.
+         */
+        std::string loading;
+
+        /** \property size_t budget
+         *  \brief Maximum number of cached bytes.
+         */
+        size_t budget;
+
+        /** \property uint64_t stamp
+         *  \brief Use counter.
+         */
+        uint64_t stamp = 0;
+
+        /** \property Stats stats
+         *  \brief Cache statistics.
+         */
+        Stats stats;
+
+        /** \property bool stopping
+         *  \brief If true, worker thread must exit.
+         */
+        bool stopping = false;
+
+        /** \property mutable std::mutex mutex
+         *  \brief Protects cache, queue and statistics.
+         */
+        mutable std::mutex mutex;
+
+        /** \property std::condition_variable cond
+         *  \brief Signals queue changes and finished loads.
+         */
+        std::condition_variable cond;
+
+        /** \property std::thread worker
+         *  \brief Prefetch thread.
+         */
+        std::thread worker;
+
+        /** \fn void run()
+         *  \brief Worker thread loop.
+         */
+        void run();
+
+        /** \fn Data load(const std::string & path) const
+         *  \brief Reads a whole file. Thread-safe.
+         *  \param path: path relative to root.
+         *  \returns file content, or nullptr if failed.
+         */
+        Data load(const std::string & path) const;
+
+        /** \fn void insert(const std::string & path, const Data & data)
+         *  \brief Adds a file to cache, evicting others to stay within
+         *  budget. Files larger than budget are not cached. Lock must be held.
+         *  \param path: file path.
+         *  \param data: file content.
+         */
+        void insert(const std::string & path, const Data & data);
+
+        /** \fn void trim(size_t size)
+         *  \brief Evicts least recently used files until cache holds at
+         *  most the given number of bytes. Lock must be held.
+         *  \param size: number of bytes to keep.
+         */
+        void trim(size_t size);
+
+    protected:
+        bool ready_cb() override;
+        void * open_cb(const char * path, lv_fs_mode_t mode) override;
+        lv_fs_res_t close_cb(void * file_p) override;
+        lv_fs_res_t read_cb(void * file_p, void * buf, uint32_t btr, uint32_t * br) override;
+        lv_fs_res_t write_cb(void * file_p, const void * buf, uint32_t btw, uint32_t * bw) override;
+        lv_fs_res_t seek_cb(void * file_p, uint32_t pos, lv_fs_whence_t whence) override;
+        lv_fs_res_t tell_cb(void * file_p, uint32_t * pos_p) override;
+        void * dir_open_cb(const char * path) override;
+        lv_fs_res_t dir_read_cb(void * rddir_p, char * fn) override;
+        lv_fs_res_t dir_close_cb(void * rddir_p) override;
+
+    public:
+        /** \fn PrefetchFileSystem(char letter, const std::string & root = "", size_t budget = 256*1024)
+         *  \brief Constructor. Starts worker thread.
+         *  \param letter: registration letter for LVGL.
+         *  \param root: directory prepended to paths, as seen by C stdio.
+         *  \param budget: maximum number of cached bytes.
+         */
+        PrefetchFileSystem(char letter, const std::string & root = "", size_t budget = 256*1024);
+
+        /** \fn ~PrefetchFileSystem()
+         *  \brief Destructor. Stops worker thread. Files must be closed.
+         */
+        ~PrefetchFileSystem();
+
+        /** \fn void prefetch(const std::string & path)
+         *  \brief Queues a file for prefetching.
+         *  \param path: file path, without drive letter.
+         */
+        void prefetch(const std::string & path);
+
+        /** \fn void prefetch(const std::vector<std::string> & paths)
+         *  \brief Queues files for prefetching, in given order.
+         *  \param paths: file paths, without drive letter.
+         */
+        void prefetch(const std::vector<std::string> & paths);
+
+        /** \fn void cancel()
+         *  \brief Drops queued paths not loaded yet.
+         */
+        void cancel();
+
+        /** \fn bool contains(const std::string & path) const
+         *  \brief Checks if a file is in cache.
+         *  \param path: file path, without drive letter.
+         *  \returns true if file is cached, false otherwise.
+         */
+        bool contains(const std::string & path) const;
+
+        /** \fn bool is_idle() const
+         *  \brief Checks if worker thread has nothing left to load.
+         *  \returns true if queue is empty and no load is running.
+         */
+        bool is_idle() const;
+
+        /** \fn void evict(const std::string & path)
+         *  \brief Removes a file from cache.
+         *  \param path: file path, without drive letter.
+         */
+        void evict(const std::string & path);
+
+        /** \fn void clear()
+         *  \brief Removes all files from cache.
+         */
+        void clear();
+
+        /** \fn void set_budget(size_t budget)
+         *  \brief Sets maximum number of cached bytes, evicting files if needed.
+         *  \param budget: maximum number of cached bytes.
+         */
+        void set_budget(size_t budget);
+
+        /** \fn Stats get_stats() const
+         *  \brief Gets cache statistics.
+         *  \returns cache statistics.
+         */
+        Stats get_stats() const;
+    };
+
+}
+#endif // LV_USE_USER_DATA
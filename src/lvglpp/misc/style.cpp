@@ -4,6 +4,8 @@
  *  Author: Vincent Paeder
  *  License: MIT
  */
+#include <algorithm>
+#include <cstring>
 #include "style.h"
 
 #define LV_ANIM_RESOLUTION 1024 ///< span of animation internal counter
@@ -29,11 +31,15 @@ namespace lvgl::misc {
             auto obj = reinterpret_cast<StyleTransition*>(anim->user_data);
             return obj->callback(anim);
         };
-        lv_style_transition_dsc_init(this->raw_ptr(), props.data(), path_xcb, time, delay, static_cast<void*>(this));
+        lv_style_transition_dsc_init(this->raw_ptr(), nullptr, path_xcb, time, delay, static_cast<void*>(this));
+        this->set_props(props);
     }
 
     void StyleTransition::set_props(const std::vector<lv_style_prop_t> & props) {
-        this->lv_obj->props = props.data();
+        this->props = props;
+        if (this->props.empty() || this->props.back() != LV_STYLE_PROP_INV)
+            this->props.push_back(LV_STYLE_PROP_INV);
+        this->lv_obj->props = this->props.data();
     }
 
     void StyleTransition::set_time(uint32_t time) {
@@ -84,6 +90,24 @@ namespace lvgl::misc {
         return new_value;
     }
 
+    EasingStyleTransition::EasingStyleTransition(const std::vector<lv_style_prop_t> & props,
+                                                 std::shared_ptr<const EasingTable> easing,
+                                                 uint32_t time, uint32_t delay)
+        : StyleTransition(props, time, delay) {
+        this->set_easing(easing);
+    }
+
+    void EasingStyleTransition::set_easing(std::shared_ptr<const EasingTable> easing) {
+        this->easing = easing;
+        // LVGL copies user_data to the transition animation
+        this->lv_obj->path_xcb = EasingTable::path_cb;
+        this->lv_obj->user_data = const_cast<void*>(static_cast<const void*>(this->easing.get()));
+    }
+
+    int32_t EasingStyleTransition::callback(const struct _lv_anim_t * anim) {
+        return this->easing->map(anim->act_time, anim->time, anim->start_value, anim->end_value);
+    }
+
     #endif // LV_USE_USER_DATA
 
     Style::Style() {
@@ -135,10 +159,104 @@ namespace lvgl::misc {
         return value;
     }
 
+    std::vector<StyleProperty> Style::get_props() const {
+        // this mirrors the storage layout walked by lv_style_get_prop_inlined
+        std::vector<StyleProperty> props;
+        auto style = this->raw_ptr();
+        if (style->prop1 == LV_STYLE_PROP_ANY) {
+            // constant style: array terminated by LV_STYLE_PROP_INV
+            for (auto p = style->v_p.const_props; p->prop != LV_STYLE_PROP_INV; p++)
+                props.push_back({p->prop, p->value});
+        } else if (style->prop_cnt > 1) {
+            auto values = reinterpret_cast<const lv_style_value_t*>(style->v_p.values_and_props);
+            auto ids = reinterpret_cast<const lv_style_prop_t*>(style->v_p.values_and_props
+                                                                + style->prop_cnt * sizeof(lv_style_value_t));
+            props.reserve(style->prop_cnt);
+            for (uint32_t n=0; n<style->prop_cnt; n++)
+                props.push_back({ids[n], values[n]});
+        } else if (style->prop_cnt == 1) {
+            props.push_back({style->prop1, style->v_p.value1});
+        }
+        return props;
+    }
+
     void Style::report_style_change() {
         lv_obj_report_style_change(this->raw_ptr());
     }
 
+    /** \fn static void report_props_change(const lv_style_t * style, lv_obj_t * obj, const std::vector<lv_style_prop_t> & props)
+     *  \brief Refreshes given properties on an object tree wherever the style is used.
+     *  \param style: modified style.
+     *  \param obj: root of object tree.
+     *  \param props: properties to refresh.
+     */
+    static void report_props_change(const lv_style_t * style, lv_obj_t * obj, const std::vector<lv_style_prop_t> & props) {
+        // the style may be used by several parts; refresh each of them once
+        std::vector<lv_part_t> parts;
+        for (uint32_t n=0; n<obj->style_cnt; n++) {
+            if (obj->styles[n].style != style) continue;
+            auto part = lv_obj_style_get_selector_part(obj->styles[n].selector);
+            if (std::find(parts.begin(), parts.end(), part) != parts.end()) continue;
+            parts.push_back(part);
+            for (auto prop : props)
+                lv_obj_refresh_style(obj, part, prop);
+        }
+        auto child_cnt = lv_obj_get_child_cnt(obj);
+        for (uint32_t n=0; n<child_cnt; n++)
+            report_props_change(style, lv_obj_get_child(obj, n), props);
+    }
+
+    void Style::report_style_change(const std::vector<lv_style_prop_t> & props) {
+        // lv_obj_refresh_style only acts upon the flags of the given property;
+        // we keep one property per flag combination to avoid redundant work
+        constexpr uint8_t flags[] = {LV_STYLE_PROP_INHERIT, LV_STYLE_PROP_EXT_DRAW,
+                                     LV_STYLE_PROP_LAYOUT_REFR, LV_STYLE_PROP_PARENT_LAYOUT_REFR,
+                                     LV_STYLE_PROP_LAYER_REFR};
+        std::vector<lv_style_prop_t> refresh;
+        std::vector<uint8_t> refresh_flags;
+        for (auto prop : props) {
+            prop = LV_STYLE_PROP_ID_MASK(prop);
+            if (prop == LV_STYLE_PROP_ANY) {
+                this->report_style_change();
+                return;
+            }
+            uint8_t prop_flags = 0;
+            for (auto f : flags)
+                if (lv_style_prop_has_flag(prop, f)) prop_flags |= f;
+            if (std::find(refresh_flags.begin(), refresh_flags.end(), prop_flags) == refresh_flags.end()) {
+                refresh.push_back(prop);
+                refresh_flags.push_back(prop_flags);
+            }
+        }
+        if (refresh.empty()) return;
+        for (auto disp = lv_disp_get_next(nullptr); disp != nullptr; disp = lv_disp_get_next(disp))
+            for (uint32_t n=0; n<disp->screen_cnt; n++)
+                report_props_change(this->raw_ptr(), disp->screens[n], refresh);
+    }
+
+    std::vector<lv_style_prop_t> Style::diff(const std::vector<StyleProperty> & before) const {
+        std::vector<lv_style_prop_t> changed;
+        auto after = this->get_props();
+        auto find = [](const std::vector<StyleProperty> & props, lv_style_prop_t prop) {
+            return std::find_if(props.begin(), props.end(), [prop](const StyleProperty & p) {
+                return LV_STYLE_PROP_ID_MASK(p.prop) == prop;
+            });
+        };
+        for (auto & p : after) {
+            auto prop = LV_STYLE_PROP_ID_MASK(p.prop);
+            auto it = find(before, prop);
+            if (it == before.end() || it->prop != p.prop
+                || std::memcmp(&it->value, &p.value, sizeof(lv_style_value_t)) != 0)
+                changed.push_back(prop);
+        }
+        for (auto & p : before) {
+            auto prop = LV_STYLE_PROP_ID_MASK(p.prop);
+            if (find(after, prop) == after.end())
+                changed.push_back(prop);
+        }
+        return changed;
+    }
+
     void Style::set_size(lv_coord_t value) {
         lv_style_set_size(this->raw_ptr(), value);
     }
@@ -553,4 +671,24 @@ namespace lvgl::misc {
         lv_style_set_grid_cell_y_align(this->raw_ptr(), value);
     }
 #endif // LV_USE_GRID
-}
\ No newline at end of file
+
+    StyleUpdate::StyleUpdate(Style & style) : style(style), before(style.get_props()) {}
+
+    StyleUpdate::~StyleUpdate() {
+        this->commit();
+    }
+
+    std::vector<lv_style_prop_t> StyleUpdate::get_changed_props() const {
+        return this->style.diff(this->before);
+    }
+
+    void StyleUpdate::commit() {
+        this->style.report_style_change(this->get_changed_props());
+        this->before = this->style.get_props();
+    }
+
+    void StyleUpdate::cancel() {
+        this->before = this->style.get_props();
+    }
+
+}
@@ -6,6 +6,7 @@
  */
 #pragma once
 #include <memory>
+#include <vector>
 #include "lvgl.h"
 #include "color.h"
 #include "anim.h"
@@ -26,6 +27,13 @@ namespace lvgl::misc {
      *  to define style transition.
      */
     class StyleTransition : public PointerWrapper<lv_style_transition_dsc_t, lv_mem_free> {
+    private:
+        /** \property std::vector<lv_style_prop_t> props
+         *  \brief Properties affected by transition, terminated by LV_STYLE_PROP_INV.
+         *  LVGL keeps a pointer to this array.
+         */
+        std::vector<lv_style_prop_t> props;
+
     protected:
         /** \fn void initialize(const std::vector<lv_style_prop_t> & props, uint32_t time, uint32_t delay)
          *  \brief Initializes style transition.
@@ -58,7 +66,8 @@ namespace lvgl::misc {
         StyleTransition(const std::vector<lv_style_prop_t> & props, uint32_t time, uint32_t delay);
 
         /** \fn void set_props(const std::vector<lv_style_prop_t> & props)
-         *  \brief Sets style properties affected by transition.
+         *  \brief Sets style properties affected by transition. The list is
+         *  copied, so the argument doesn't need to outlive the transition.
          *  \param props: a list of style properties.
          */
         void set_props(const std::vector<lv_style_prop_t> & props);
@@ -203,8 +212,63 @@ namespace lvgl::misc {
          */
             int32_t callback(const struct _lv_anim_t * anim) override;
     };
+
+
+    /** \class EasingStyleTransition
+     *  \brief This is a style transition following a precomputed easing table.
+     * 
+     *  The table is passed to LVGL as path user data and evaluated by a plain
+     *  function with integer interpolation; the virtual callback isn't involved
+     *  on animation frames.
+     */
+    class EasingStyleTransition : public StyleTransition {
+        private:
+            /** \property std::shared_ptr<const EasingTable> easing
+             *  \brief Easing table used by transition.
+             */
+            std::shared_ptr<const EasingTable> easing;
+
+        public:
+            /** \fn EasingStyleTransition(const std::vector<lv_style_prop_t> & props, std::shared_ptr<const EasingTable> easing, uint32_t time, uint32_t delay)
+             *  \brief Constructor with parameters.
+             *  \param props: a list of style properties.
+             *  \param easing: easing table; can be shared among transitions.
+             *  \param time: transition duration.
+             *  \param delay: transition delay.
+             */
+            EasingStyleTransition(const std::vector<lv_style_prop_t> & props, std::shared_ptr<const EasingTable> easing,
+                                  uint32_t time, uint32_t delay);
+
+            /** \fn void set_easing(std::shared_ptr<const EasingTable> easing)
+             *  \brief Sets easing table.
+             *  \param easing: easing table.
+             */
+            void set_easing(std::shared_ptr<const EasingTable> easing);
+
+        protected:
+        /** \fn int32_t callback(const struct _lv_anim_t * anim)
+         *  \brief Evaluates easing table (only used if called directly).
+         *  \param anim: pointer to an animation descriptor.
+         */
+            int32_t callback(const struct _lv_anim_t * anim) override;
+    };
     #endif // LV_USE_USER_DATA
 
+    /** \struct StyleProperty
+     *  \brief A style property ID (with meta flags) and its value.
+     */
+    struct StyleProperty {
+        /** \property lv_style_prop_t prop
+         *  \brief Style property ID, including meta flags.
+         */
+        lv_style_prop_t prop;
+
+        /** \property lv_style_value_t value
+         *  \brief Style property value.
+         */
+        lv_style_value_t value;
+    };
+
     /** \class Style
      *  \brief Wraps a lv_style_t object.
      */
@@ -286,11 +350,32 @@ namespace lvgl::misc {
          */
         lv_style_value_t get_prop_inlined(lv_style_prop_t prop) const;
 
+        /** \fn std::vector<StyleProperty> get_props() const
+         *  \brief Gets all properties set in style, in storage order.
+         *  \returns a list of properties with their values.
+         */
+        std::vector<StyleProperty> get_props() const;
+
         /** \fn void report_style_change()
          *  \brief Notifies objects that a style was modified.
          */
         void report_style_change();
 
+        /** \fn void report_style_change(const std::vector<lv_style_prop_t> & props)
+         *  \brief Notifies objects that given properties of a style were modified.
+         *  Unlike report_style_change(), this only triggers the refresh work
+         *  required by these properties (e.g. no relayout for a color change).
+         *  \param props: list of modified properties.
+         */
+        void report_style_change(const std::vector<lv_style_prop_t> & props);
+
+        /** \fn std::vector<lv_style_prop_t> diff(const std::vector<StyleProperty> & before) const
+         *  \brief Lists properties that differ from a previous state of the style.
+         *  \param before: previous state, as returned by get_props.
+         *  \returns IDs of properties that were added, removed or changed.
+         */
+        std::vector<lv_style_prop_t> diff(const std::vector<StyleProperty> & before) const;
+
         /** \fn void set_size(lv_coord_t value)
          *  \brief Sets size property.
          *  \param value: size value.
@@ -930,4 +1015,63 @@ namespace lvgl::misc {
 #endif // LV_USE_GRID
     };
 
+
+    /** \class StyleUpdate
+     *  \brief Records which properties of a style get modified during its
+     *  lifetime and notifies objects only about these.
+     * 
+     *  Usage:
+     *  \code
+     *  {
+     *      auto update = StyleUpdate(style);
+     *      style.set_bg_color(c);
+     *      style.set_text_color(c);
+     *  } // objects using style get refreshed for bg and text color only
+     *  \endcode
+     */
+    class StyleUpdate {
+    private:
+        /** \property Style & style
+         *  \brief Style being modified.
+         */
+        Style & style;
+
+        /** \property std::vector<StyleProperty> before
+         *  \brief Style properties at the time of the last commit.
+         */
+        std::vector<StyleProperty> before;
+
+    public:
+        /** \fn StyleUpdate(Style & style)
+         *  \brief Constructor. Takes a snapshot of the style properties.
+         *  \param style: style to be modified.
+         */
+        StyleUpdate(Style & style);
+
+        // a copy would report changes twice
+        StyleUpdate(const StyleUpdate & obj) = delete;
+        StyleUpdate & operator=(const StyleUpdate & obj) = delete;
+
+        /** \fn ~StyleUpdate()
+         *  \brief Destructor. Reports changes made since the last commit.
+         */
+        ~StyleUpdate();
+
+        /** \fn std::vector<lv_style_prop_t> get_changed_props() const
+         *  \brief Lists properties changed since construction or last commit.
+         *  \returns IDs of changed properties.
+         */
+        std::vector<lv_style_prop_t> get_changed_props() const;
+
+        /** \fn void commit()
+         *  \brief Notifies objects about changed properties and takes a new snapshot.
+         */
+        void commit();
+
+        /** \fn void cancel()
+         *  \brief Drops changes made since the last commit without notifying objects.
+         */
+        void cancel();
+    };
+
 }
@@ -0,0 +1,165 @@
+/** \file stylepool.cpp
+ *  \brief Implementation file for a pool that shares identical lv_style_t objects.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include <cstring>
+#include "stylepool.h"
+
+namespace lvgl::misc {
+
+    /** \fn static std::vector<StyleProperty> sorted_props(const Style & style)
+     *  \brief Gets style properties sorted by property ID.
+     *  \param style: style to read.
+     *  \returns sorted list of properties.
+     */
+    static std::vector<StyleProperty> sorted_props(const Style & style) {
+        auto props = style.get_props();
+        std::sort(props.begin(), props.end(), [](const StyleProperty & a, const StyleProperty & b) {
+            return LV_STYLE_PROP_ID_MASK(a.prop) < LV_STYLE_PROP_ID_MASK(b.prop);
+        });
+        return props;
+    }
+
+    /** \enum ValueType
+     *  \brief Member of lv_style_value_t in use for a property.
+     */
+    enum class ValueType : uint8_t { Num, Color, Ptr, Raw };
+
+    /** \fn static ValueType get_value_type(lv_style_prop_t prop)
+     *  \brief Tells which member of lv_style_value_t a property uses. Bytes
+     *  outside of that member are unspecified, so they must be ignored.
+     *  \param prop: style property ID, with or without meta flags.
+     *  \returns member in use; Raw for custom properties, whose type is
+     *  unknown and which are compared as a whole.
+     */
+    static ValueType get_value_type(lv_style_prop_t prop) {
+        switch (LV_STYLE_PROP_ID_MASK(prop)) {
+            case LV_STYLE_BG_COLOR: case LV_STYLE_BG_GRAD_COLOR: case LV_STYLE_BG_IMG_RECOLOR:
+            case LV_STYLE_BORDER_COLOR: case LV_STYLE_OUTLINE_COLOR: case LV_STYLE_SHADOW_COLOR:
+            case LV_STYLE_IMG_RECOLOR: case LV_STYLE_LINE_COLOR: case LV_STYLE_ARC_COLOR:
+            case LV_STYLE_TEXT_COLOR:
+                return ValueType::Color;
+            case LV_STYLE_BG_GRAD: case LV_STYLE_BG_IMG_SRC: case LV_STYLE_ARC_IMG_SRC:
+            case LV_STYLE_TEXT_FONT: case LV_STYLE_COLOR_FILTER_DSC: case LV_STYLE_ANIM:
+            case LV_STYLE_TRANSITION:
+                return ValueType::Ptr;
+            default:
+                return LV_STYLE_PROP_ID_MASK(prop) < _LV_STYLE_LAST_BUILT_IN_PROP ? ValueType::Num : ValueType::Raw;
+        }
+    }
+
+    size_t StylePool::get_hash(const Style & style) {
+        // FNV-1a over property IDs and the value member in use
+        size_t hash = 2166136261u;
+        auto mix = [&hash](const void * data, size_t size) {
+            auto bytes = static_cast<const uint8_t*>(data);
+            for (size_t n=0; n<size; n++) {
+                hash ^= bytes[n];
+                hash *= 16777619u;
+            }
+        };
+        for (auto & p : sorted_props(style)) {
+            mix(&p.prop, sizeof(p.prop));
+            switch (get_value_type(p.prop)) {
+                case ValueType::Num: mix(&p.value.num, sizeof(p.value.num)); break;
+                case ValueType::Color: mix(&p.value.color.full, sizeof(p.value.color.full)); break;
+                case ValueType::Ptr: mix(&p.value.ptr, sizeof(p.value.ptr)); break;
+                case ValueType::Raw: mix(&p.value, sizeof(p.value)); break;
+            }
+        }
+        return hash;
+    }
+
+    bool StylePool::is_equal(const Style & a, const Style & b) {
+        if (a.raw_ptr() == b.raw_ptr()) return true;
+        auto pa = sorted_props(a);
+        auto pb = sorted_props(b);
+        if (pa.size() != pb.size()) return false;
+        for (size_t n=0; n<pa.size(); n++) {
+            if (pa[n].prop != pb[n].prop) return false;
+            auto & va = pa[n].value;
+            auto & vb = pb[n].value;
+            switch (get_value_type(pa[n].prop)) {
+                case ValueType::Num: if (va.num != vb.num) return false; break;
+                case ValueType::Color: if (va.color.full != vb.color.full) return false; break;
+                case ValueType::Ptr: if (va.ptr != vb.ptr) return false; break;
+                case ValueType::Raw: if (std::memcmp(&va, &vb, sizeof(lv_style_value_t)) != 0) return false; break;
+            }
+        }
+        return true;
+    }
+
+    std::shared_ptr<Style> StylePool::find(const Style & style, size_t hash) {
+        auto range = this->entries.equal_range(hash);
+        for (auto it = range.first; it != range.second;) {
+            auto shared = it->second.lock();
+            if (shared == nullptr) {
+                it = this->entries.erase(it);
+                continue;
+            }
+            if (is_equal(*shared, style))
+                return shared;
+            it++;
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<Style> StylePool::intern(const Style & style) {
+        this->lookups++;
+        auto hash = get_hash(style);
+        auto shared = this->find(style, hash);
+        if (shared != nullptr) {
+            this->collapsed++;
+            return shared;
+        }
+        shared = std::make_shared<Style>();
+        for (auto & p : style.get_props())
+            shared->set_prop(p.prop, p.value);
+        this->entries.emplace(hash, shared);
+        return shared;
+    }
+
+    std::shared_ptr<Style> StylePool::intern(const std::shared_ptr<Style> & style) {
+        this->lookups++;
+        auto hash = get_hash(*style);
+        auto shared = this->find(*style, hash);
+        if (shared != nullptr) {
+            if (shared != style) this->collapsed++;
+            return shared;
+        }
+        this->entries.emplace(hash, style);
+        return style;
+    }
+
+    void StylePool::purge() {
+        for (auto it = this->entries.begin(); it != this->entries.end();) {
+            if (it->second.expired())
+                it = this->entries.erase(it);
+            else
+                it++;
+        }
+    }
+
+    void StylePool::clear() {
+        this->entries.clear();
+        this->lookups = 0;
+        this->collapsed = 0;
+    }
+
+    size_t StylePool::size() const {
+        return std::count_if(this->entries.begin(), this->entries.end(),
+                             [](auto & e) { return !e.second.expired(); });
+    }
+
+    uint32_t StylePool::get_lookups() const {
+        return this->lookups;
+    }
+
+    uint32_t StylePool::get_duplicates_collapsed() const {
+        return this->collapsed;
+    }
+
+}
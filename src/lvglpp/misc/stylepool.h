@@ -0,0 +1,122 @@
+/** \file stylepool.h
+ *  \brief Header file for a pool that shares identical lv_style_t objects.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include "style.h"
+
+namespace lvgl::misc {
+
+    /** \class StylePool
+     *  \brief Interns styles: identical property sets are collapsed into one
+     *  shared Style instance.
+     * 
+     *  Two styles are identical if they hold the same properties (including
+     *  meta flags) with identical values, regardless of the order in which
+     *  properties were set. Values are compared as numbers, colors or
+     *  pointers depending on the property, as other bytes of
+     *  lv_style_value_t are unspecified. The pool only keeps weak references, so a
+     *  shared style gets freed when the last shared_ptr to it goes away.
+     *  Styles returned by the pool are shared: modifying one affects every
+     *  user, and an interned style that gets modified won't be matched again.
+     */
+    class StylePool {
+    private:
+        /** \property std::unordered_multimap<size_t, std::weak_ptr<Style>> entries
+         *  \brief Interned styles, indexed by property set hash.
+         */
+        std::unordered_multimap<size_t, std::weak_ptr<Style>> entries;
+
+        /** \property uint32_t lookups
+         *  \brief Number of intern requests.
+         */
+        uint32_t lookups = 0;
+
+        /** \property uint32_t collapsed
+         *  \brief Number of intern requests that returned an existing style.
+         */
+        uint32_t collapsed = 0;
+
+        /** \fn std::shared_ptr<Style> find(const Style & style, size_t hash)
+         *  \brief Looks for an interned style identical to the given one.
+         *  Expired entries met on the way are removed.
+         *  \param style: style to look for.
+         *  \param hash: style hash, as returned by get_hash.
+         *  \returns the interned style, or nullptr if none matches.
+         */
+        std::shared_ptr<Style> find(const Style & style, size_t hash);
+
+    public:
+        /** \fn StylePool()
+         *  \brief Default constructor.
+         */
+        StylePool() = default;
+
+        /** \fn std::shared_ptr<Style> intern(const Style & style)
+         *  \brief Gets the shared style identical to the given one. If there
+         *  is none, a copy of the given style is added to the pool.
+         *  \param style: style to intern; remains owned by the caller.
+         *  \returns shared style.
+         */
+        std::shared_ptr<Style> intern(const Style & style);
+
+        /** \fn std::shared_ptr<Style> intern(const std::shared_ptr<Style> & style)
+         *  \brief Gets the shared style identical to the given one. If there
+         *  is none, the given style is added to the pool without copy.
+         *  \param style: style to intern.
+         *  \returns shared style.
+         */
+        std::shared_ptr<Style> intern(const std::shared_ptr<Style> & style);
+
+        /** \fn void purge()
+         *  \brief Removes entries of styles that have been freed.
+         */
+        void purge();
+
+        /** \fn void clear()
+         *  \brief Removes all entries and resets statistics. Styles
+         *  already handed out remain valid.
+         */
+        void clear();
+
+        /** \fn size_t size() const
+         *  \brief Gets the number of styles alive in pool.
+         *  \returns number of styles.
+         */
+        size_t size() const;
+
+        /** \fn uint32_t get_lookups() const
+         *  \brief Gets the number of intern requests.
+         *  \returns number of requests.
+         */
+        uint32_t get_lookups() const;
+
+        /** \fn uint32_t get_duplicates_collapsed() const
+         *  \brief Gets the number of intern requests that were served with
+         *  an existing style instead of a new one.
+         *  \returns number of duplicates collapsed.
+         */
+        uint32_t get_duplicates_collapsed() const;
+
+        /** \fn static size_t get_hash(const Style & style)
+         *  \brief Computes a hash of the style's property set. This doesn't
+         *  depend on the order in which properties were set.
+         *  \param style: style to hash.
+         *  \returns hash value.
+         */
+        static size_t get_hash(const Style & style);
+
+        /** \fn static bool is_equal(const Style & a, const Style & b)
+         *  \brief Tells if two styles hold the same property set.
+         *  \param a: first style.
+         *  \param b: second style.
+         *  \returns true if property sets are identical, false otherwise.
+         */
+        static bool is_equal(const Style & a, const Style & b);
+    };
+
+}
@@ -0,0 +1,199 @@
+/** \file timerwheel.cpp
+ *  \brief Implementation file for a timer wheel multiplexed onto a LVGL timer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#include <algorithm>
+#include "timerwheel.h"
+
+// Timer requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    TimerWheel::TimerWheel(uint32_t resolution) : Timer(std::max<uint32_t>(resolution, 1)) {
+        this->resolution = std::max<uint32_t>(resolution, 1);
+        this->heads.fill(nil);
+        this->pause();
+    }
+
+    void TimerWheel::link(uint32_t idx, uint32_t list) {
+        auto & node = this->nodes[idx];
+        node.list = list;
+        node.prev = nil;
+        node.next = this->heads[list];
+        if (node.next != nil)
+            this->nodes[node.next].prev = idx;
+        this->heads[list] = idx;
+    }
+
+    void TimerWheel::unlink(uint32_t idx) {
+        auto & node = this->nodes[idx];
+        if (node.list == nil) return;
+        if (node.prev != nil)
+            this->nodes[node.prev].next = node.next;
+        else
+            this->heads[node.list] = node.next;
+        if (node.next != nil)
+            this->nodes[node.next].prev = node.prev;
+        node.list = node.prev = node.next = nil;
+    }
+
+    void TimerWheel::schedule(uint32_t idx) {
+        auto & node = this->nodes[idx];
+        uint32_t delta = node.expires - this->now;
+        // timers further than the wheel span wait in the top level and get
+        // rescheduled when their slot comes up
+        constexpr uint32_t max_delta = (1u << (slot_bits * levels)) - 1;
+        uint32_t expires = delta > max_delta ? this->now + max_delta : node.expires;
+        if (delta > max_delta) delta = max_delta;
+        uint32_t level = 0;
+        while (level < levels - 1 && delta >= (1u << (slot_bits * (level + 1))))
+            level++;
+        uint32_t slot = (expires >> (slot_bits * level)) & (slots - 1);
+        this->link(idx, level * slots + slot);
+    }
+
+    void TimerWheel::release(uint32_t idx) {
+        auto & node = this->nodes[idx];
+        node.callback = nullptr;
+        node.state = State::Free;
+        node.generation++;
+        if (node.generation == 0) node.generation = 1;
+        this->free_nodes.push_back(idx);
+    }
+
+    TimerWheel::Node * TimerWheel::get_node(Handle handle) {
+        uint32_t idx = static_cast<uint32_t>(handle);
+        uint32_t generation = static_cast<uint32_t>(handle >> 32);
+        if (idx >= this->nodes.size()) return nullptr;
+        auto & node = this->nodes[idx];
+        if (node.generation != generation || node.state == State::Free) return nullptr;
+        return &node;
+    }
+
+    uint32_t TimerWheel::to_ticks(uint32_t ms) const {
+        return std::max<uint32_t>((ms + this->resolution - 1) / this->resolution, 1);
+    }
+
+    void TimerWheel::advance() {
+        this->now++;
+        // redistribute upper level slots whose span starts now
+        for (uint32_t level=1; level<levels; level++) {
+            if ((this->now & ((1u << (slot_bits * level)) - 1)) != 0) break;
+            uint32_t slot = (this->now >> (slot_bits * level)) & (slots - 1);
+            uint32_t list = level * slots + slot;
+            uint32_t idx = this->heads[list];
+            this->heads[list] = nil;
+            while (idx != nil) {
+                uint32_t next = this->nodes[idx].next;
+                this->nodes[idx].list = nil;
+                this->schedule(idx);
+                idx = next;
+            }
+        }
+        // move due timers to the expiring list, so that callbacks can
+        // cancel any of them
+        uint32_t list = this->now & (slots - 1);
+        uint32_t idx = this->heads[list];
+        this->heads[list] = nil;
+        while (idx != nil) {
+            uint32_t next = this->nodes[idx].next;
+            this->nodes[idx].list = nil;
+            this->link(idx, expiring);
+            idx = next;
+        }
+        while (this->heads[expiring] != nil) {
+            idx = this->heads[expiring];
+            this->unlink(idx);
+            this->nodes[idx].state = State::Running;
+            this->nodes[idx].callback();
+            // nodes don't move: the callback may only have added nodes
+            auto & node = this->nodes[idx];
+            if (node.state == State::Running && node.period > 0) {
+                node.state = State::Pending;
+                node.expires += node.period;
+                if (static_cast<int32_t>(node.expires - this->now) <= 0)
+                    node.expires = this->now + 1;
+                this->schedule(idx);
+            } else {
+                this->release(idx);
+                this->pending--;
+            }
+        }
+    }
+
+    void TimerWheel::callback(Timer & timer) {
+        uint32_t ticks = lv_tick_elaps(this->last_tick) / this->resolution;
+        this->last_tick += ticks * this->resolution;
+        while (ticks-- > 0 && this->pending > 0)
+            this->advance();
+        if (this->pending == 0)
+            this->pause();
+    }
+
+    TimerWheel::Handle TimerWheel::add(uint32_t timeout, Callback callback, uint32_t period) {
+        uint32_t idx;
+        if (this->free_nodes.empty()) {
+            idx = static_cast<uint32_t>(this->nodes.size());
+            this->nodes.emplace_back();
+        } else {
+            idx = this->free_nodes.back();
+            this->free_nodes.pop_back();
+        }
+        auto & node = this->nodes[idx];
+        node.callback = std::move(callback);
+        node.expires = this->now + this->to_ticks(timeout);
+        node.period = period > 0 ? this->to_ticks(period) : 0;
+        node.state = State::Pending;
+        this->schedule(idx);
+        if (this->pending++ == 0) {
+            this->last_tick = lv_tick_get();
+            this->resume();
+        }
+        return (static_cast<Handle>(node.generation) << 32) | idx;
+    }
+
+    bool TimerWheel::cancel(Handle handle) {
+        auto node = this->get_node(handle);
+        if (node == nullptr || node->state == State::Cancelled) return false;
+        if (node->state == State::Running) {
+            // released once the callback returns
+            node->state = State::Cancelled;
+            return true;
+        }
+        this->unlink(static_cast<uint32_t>(handle));
+        this->release(static_cast<uint32_t>(handle));
+        this->pending--;
+        return true;
+    }
+
+    bool TimerWheel::restart(Handle handle, uint32_t timeout) {
+        auto node = this->get_node(handle);
+        if (node == nullptr || node->state != State::Pending) return false;
+        this->unlink(static_cast<uint32_t>(handle));
+        node->expires = this->now + this->to_ticks(timeout);
+        this->schedule(static_cast<uint32_t>(handle));
+        return true;
+    }
+
+    bool TimerWheel::is_pending(Handle handle) {
+        auto node = this->get_node(handle);
+        return node != nullptr && node->state == State::Pending;
+    }
+
+    uint32_t TimerWheel::size() const {
+        return this->pending;
+    }
+
+    void TimerWheel::reserve(uint32_t count) {
+        this->free_nodes.reserve(count);
+        while (this->nodes.size() < count) {
+            this->free_nodes.push_back(static_cast<uint32_t>(this->nodes.size()));
+            this->nodes.emplace_back();
+        }
+    }
+
+}
+#endif // LV_USE_USER_DATA
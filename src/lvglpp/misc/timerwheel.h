@@ -0,0 +1,262 @@
+/** \file timerwheel.h
+ *  \brief Header file for a timer wheel multiplexed onto a LVGL timer.
+ *
+ *  Author: Vincent Paeder
+ *  License: MIT
+ */
+#pragma once
+#include <array>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "timer.h"
+
+// Timer requires user_data
+#if LV_USE_USER_DATA
+
+namespace lvgl::misc {
+
+    /** \class TimerWheel
+     *  \brief Runs many one-shot and periodic timers from a single LVGL timer.
+     * 
+     *  Timers are stored in a hierarchical wheel: 4 levels of 64 slots,
+     *  each level covering 64 times the span of the previous one. Adding
+     *  and cancelling a timer are O(1); on each tick, only the current slot
+     *  is visited and, every 64 ticks, one slot of the upper level gets
+     *  redistributed. Timer nodes are pooled and reused. Handles carry a
+     *  generation count, so a stale handle never cancels a newer timer.
+     */
+    class TimerWheel : public Timer {
+    public:
+        /** \typedef Handle
+         *  \brief Timer identifier; 0 is never a valid handle.
+         */
+        using Handle = uint64_t;
+
+        /** \typedef Callback
+         *  \brief Function called when a timer expires.
+         */
+        using Callback = std::function<void()>;
+
+    private:
+        /** \property static constexpr uint32_t slot_bits
+         *  \brief log2 of the number of slots per level.
+         */
+        static constexpr uint32_t slot_bits = 6;
+
+        /** \property static constexpr uint32_t slots
+         *  \brief Number of slots per level.
+         */
+        static constexpr uint32_t slots = 1 << slot_bits;
+
+        /** \property static constexpr uint32_t levels
+         *  \brief Number of levels.
+         */
+        static constexpr uint32_t levels = 4;
+
+        /** \property static constexpr uint32_t nil
+         *  \brief Null node index.
+         */
+        static constexpr uint32_t nil = UINT32_MAX;
+
+        /** \property static constexpr uint32_t expiring
+         *  \brief Index of the list holding timers being fired.
+         */
+        static constexpr uint32_t expiring = levels * slots;
+
+        /** \enum State
+         *  \brief Timer node state.
+         */
+        enum class State : uint8_t { Free, Pending, Running, Cancelled };
+
+        /** \struct Node
+         *  \brief Timer node.
+         */
+        struct Node {
+            /** \property Callback callback
+             *  \brief Function called on expiry.
+             */
+            Callback callback;
+
+            /** \property uint32_t expires
+             *  \brief Expiry time, in ticks.
+             */
+            uint32_t expires = 0;
+
+            /** \property uint32_t period
+             *  \brief Repetition period, in ticks; 0=one-shot.
+             */
+            uint32_t period = 0;
+
+            /** \property uint32_t generation
+             *  \brief Incremented each time the node gets freed.
+             */
+            uint32_t generation = 1;
+
+            /** \property uint32_t list
+             *  \brief Index of list holding the node.
+             */
+            uint32_t list = nil;
+
+            /** \property uint32_t prev
+             *  \brief Previous node in list.
+             */
+            uint32_t prev = nil;
+
+            /** \property uint32_t next
+             *  \brief Next node in list.
+             */
+            uint32_t next = nil;
+
+            /** \property State state
+             *  \brief Node state.
+             */
+            State state = State::Free;
+        };
+
+        /** \property std::deque<Node> nodes
+         *  \brief Node pool. A deque keeps nodes in place while callbacks
+         *  add timers.
+         */
+        std::deque<Node> nodes;
+
+        /** \property std::vector<uint32_t> free_nodes
+         *  \brief Indices of unused nodes.
+         */
+        std::vector<uint32_t> free_nodes;
+
+        /** \property std::array<uint32_t, levels*slots+1> heads
+         *  \brief First node of each slot, and of expiring timer list.
+         */
+        std::array<uint32_t, levels*slots+1> heads;
+
+        /** \property uint32_t resolution
+         *  \brief Duration of a tick, in ms.
+         */
+        uint32_t resolution;
+
+        /** \property uint32_t now
+         *  \brief Current time, in ticks.
+         */
+        uint32_t now = 0;
+
+        /** \property uint32_t last_tick
+         *  \brief LVGL tick at which wheel was last advanced.
+         */
+        uint32_t last_tick = 0;
+
+        /** \property uint32_t pending
+         *  \brief Number of scheduled timers.
+         */
+        uint32_t pending = 0;
+
+        /** \fn void link(uint32_t idx, uint32_t list)
+         *  \brief Inserts a node at the front of a list.
+         *  \param idx: node index.
+         *  \param list: list index.
+         */
+        void link(uint32_t idx, uint32_t list);
+
+        /** \fn void unlink(uint32_t idx)
+         *  \brief Removes a node from its list.
+         *  \param idx: node index.
+         */
+        void unlink(uint32_t idx);
+
+        /** \fn void schedule(uint32_t idx)
+         *  \brief Puts a node in the slot matching its expiry time.
+         *  \param idx: node index.
+         */
+        void schedule(uint32_t idx);
+
+        /** \fn void release(uint32_t idx)
+         *  \brief Returns a node to the pool.
+         *  \param idx: node index.
+         */
+        void release(uint32_t idx);
+
+        /** \fn Node * get_node(Handle handle)
+         *  \brief Gets the node a handle refers to.
+         *  \param handle: timer handle.
+         *  \returns pointer to node, or nullptr if handle is stale.
+         */
+        Node * get_node(Handle handle);
+
+        /** \fn uint32_t to_ticks(uint32_t ms) const
+         *  \brief Converts a duration to ticks, rounding up.
+         *  \param ms: duration, in ms.
+         *  \returns duration, in ticks; at least 1.
+         */
+        uint32_t to_ticks(uint32_t ms) const;
+
+        /** \fn void advance()
+         *  \brief Advances time by one tick and fires due timers.
+         */
+        void advance();
+
+    public:
+        /** \fn TimerWheel(uint32_t resolution = 1)
+         *  \brief Constructor.
+         *  \param resolution: duration of a tick, in ms; this is the period of
+         *  the underlying LVGL timer.
+         */
+        TimerWheel(uint32_t resolution = 1);
+
+        // the timer holds a pointer to this instance: no copy or move
+        TimerWheel(const TimerWheel &) = delete;
+        TimerWheel & operator=(const TimerWheel &) = delete;
+        TimerWheel(TimerWheel &&) = delete;
+        TimerWheel & operator=(TimerWheel &&) = delete;
+
+        /** \fn void callback(Timer & timer) override
+         *  \brief Advances wheel by the time elapsed since last call.
+         *  \param timer: timer instance.
+         */
+        void callback(Timer & timer) override;
+
+        /** \fn Handle add(uint32_t timeout, Callback callback, uint32_t period = 0)
+         *  \brief Schedules a timer.
+         *  \param timeout: delay before first call, in ms.
+         *  \param callback: function to call.
+         *  \param period: repetition period, in ms; 0=one-shot.
+         *  \returns timer handle.
+         */
+        Handle add(uint32_t timeout, Callback callback, uint32_t period = 0);
+
+        /** \fn bool cancel(Handle handle)
+         *  \brief Cancels a timer. A timer may cancel itself from its callback.
+         *  \param handle: timer handle.
+         *  \returns true if timer was pending, false otherwise.
+         */
+        bool cancel(Handle handle);
+
+        /** \fn bool restart(Handle handle, uint32_t timeout)
+         *  \brief Reschedules a pending timer, e.g. to push back a timeout.
+         *  \param handle: timer handle.
+         *  \param timeout: new delay before call, in ms.
+         *  \returns true if timer was pending, false otherwise.
+         */
+        bool restart(Handle handle, uint32_t timeout);
+
+        /** \fn bool is_pending(Handle handle)
+         *  \brief Tells if a timer is scheduled.
+         *  \param handle: timer handle.
+         *  \returns true if timer is scheduled, false otherwise.
+         */
+        bool is_pending(Handle handle);
+
+        /** \fn uint32_t size() const
+         *  \brief Gets the number of scheduled timers.
+         *  \returns number of timers.
+         */
+        uint32_t size() const;
+
+        /** \fn void reserve(uint32_t count)
+         *  \brief Preallocates timer nodes.
+         *  \param count: number of nodes to allocate.
+         */
+        void reserve(uint32_t count);
+    };
+
+}
+#endif // LV_USE_USER_DATA
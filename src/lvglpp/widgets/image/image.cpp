@@ -9,15 +9,45 @@
 #if LV_USE_IMG != 0
 
 #include "../../draw/image.h"
+#include "../../draw/imgcache.h"
 
 namespace lvgl::widgets {
 
     void Image::set_src(const ImageDescriptor & src) {
-        lv_img_set_src(this->raw_ptr(), src.raw_ptr());
+        auto buffer = src.get_buffer();
+        if (buffer.is_empty() || src.raw_ptr() == nullptr) {
+            lv_img_set_src(this->raw_ptr(), src.raw_ptr());
+            draw::ImageCache::detach(this->raw_ptr());
+            return;
+        }
+        // shared pixels: the object holds its own descriptor, released
+        // like cached images when the object is deleted or set again
+        auto header = src.raw_ptr()->header;
+        auto image = std::make_shared<const ImageDescriptor>(buffer, static_cast<uint32_t>(header.w),
+            static_cast<uint32_t>(header.h), static_cast<lv_img_cf_t>(header.cf));
+        lv_img_set_src(this->raw_ptr(), image->raw_ptr());
+        draw::ImageCache::attach(this->raw_ptr(), image);
     }
 
     void Image::set_src(const std::string & src) {
         lv_img_set_src(this->raw_ptr(), src.c_str());
+        draw::ImageCache::detach(this->raw_ptr());
+    }
+
+    bool Image::set_src(draw::ImageCache & cache, const std::string & src) {
+        auto image = cache.get(src);
+        if (image == nullptr) return false;
+        lv_img_set_src(this->raw_ptr(), image->raw_ptr());
+        draw::ImageCache::attach(this->raw_ptr(), image);
+        return true;
+    }
+
+    bool Image::set_src(draw::ImageCache & cache, const ImageDescriptor & src) {
+        auto image = cache.get(src);
+        if (image == nullptr) return false;
+        lv_img_set_src(this->raw_ptr(), image->raw_ptr());
+        draw::ImageCache::attach(this->raw_ptr(), image);
+        return true;
     }
 
     void Image::set_offset_x(lv_coord_t x) {
@@ -10,6 +10,10 @@
 
 #if LV_USE_IMG != 0
 
+namespace lvgl::draw {
+    class ImageCache;
+}
+
 namespace lvgl::widgets {
 
     using namespace lvgl::core;
@@ -22,7 +26,11 @@ namespace lvgl::widgets {
         using Widget::Widget;
 
         /** \fn void set_src(const ImageDescriptor & src)
-         *  \brief Sets image source from image descriptor.
+         *  \brief Sets image source from image descriptor. If pixel data is
+         *  shared (see ImageDescriptor::share), the object keeps its own
+         *  descriptor and a reference to the pixels until its source
+         *  changes or it is deleted, so src may go away. Otherwise, src
+         *  must outlive its use by the object.
          *  \param src: image descriptor.
          */
         void set_src(const ImageDescriptor & src);
@@ -33,6 +41,25 @@ namespace lvgl::widgets {
          */
         void set_src(const std::string & src);
 
+        /** \fn bool set_src(draw::ImageCache & cache, const std::string & src)
+         *  \brief Sets image source to a decoded image from cache. The image
+         *  is kept alive until the source changes or the object is deleted.
+         *  \param cache: image cache.
+         *  \param src: file path.
+         *  \returns true if successful, false if image couldn't be decoded.
+         */
+        bool set_src(draw::ImageCache & cache, const std::string & src);
+
+        /** \fn bool set_src(draw::ImageCache & cache, const ImageDescriptor & src)
+         *  \brief Sets image source to a decoded copy of a descriptor from
+         *  cache. The copy is kept alive until the source changes or the
+         *  object is deleted.
+         *  \param cache: image cache.
+         *  \param src: image descriptor.
+         *  \returns true if successful, false if image couldn't be decoded.
+         */
+        bool set_src(draw::ImageCache & cache, const ImageDescriptor & src);
+
         /** \fn void set_offset_x(lv_coord_t x)
          *  \brief Sets image offset in x direction.
          *  \param x: offset in x direction.
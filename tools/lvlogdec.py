@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Decodes binary logs written by lvgl::misc::BinaryLog::dump.
+
+Usage: lvlogdec.py [input_file]   (reads standard input if omitted)
+
+Author: Vincent Paeder
+License: MIT
+"""
+import re
+import struct
+import sys
+
+LEVELS = ["Trace", "Info", "Warn", "Error", "User"]
+SPEC = re.compile(r"%([-+ #0]*[0-9*]*(?:\.[0-9*]*)?)(hh|h|ll|l|L|q|j|z|t)?([diouxXeEfFgGaAcsp%])")
+
+
+def read_args(data, count):
+    args = []
+    pos = 0
+    for _ in range(count):
+        tag = chr(data[pos])
+        pos += 1
+        if tag == "s":
+            n = data[pos]
+            args.append(data[pos + 1:pos + 1 + n].decode("utf-8", "replace"))
+            pos += 1 + n
+        elif tag == "i":
+            args.append(struct.unpack_from("<q", data, pos)[0])
+            pos += 8
+        elif tag == "d":
+            args.append(struct.unpack_from("<d", data, pos)[0])
+            pos += 8
+        else:
+            args.append(struct.unpack_from("<Q", data, pos)[0])
+            pos += 8
+    return args
+
+
+def format_message(fmt, args):
+    args = list(args)
+
+    def convert(match):
+        flags, _, conv = match.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return match.group(0)
+        value = args.pop(0)
+        if conv == "s" or isinstance(value, str):
+            return ("%" + flags + "s") % (value,)
+        if conv == "p":
+            return ("%" + flags + "s") % hex(value)
+        if conv in "eEfFgGaA":
+            conv = "e" if conv in "aA" else conv
+            return ("%" + flags + conv) % float(value)
+        if conv == "c":
+            return chr(int(value))
+        if conv == "u":
+            conv = "d"
+        return ("%" + flags + conv) % int(value)
+
+    return SPEC.sub(convert, fmt)
+
+
+def decode(data, out):
+    formats = {}
+    pos = 0
+    while pos < len(data):
+        if data[pos:pos + 4] == b"LVBL":
+            pos += 6
+            continue
+        kind = chr(data[pos])
+        pos += 1
+        if kind == "F":
+            fid, level, line = struct.unpack_from("<QBI", data, pos)
+            pos += 13
+            n = struct.unpack_from("<H", data, pos)[0]
+            fmt = data[pos + 2:pos + 2 + n].decode("utf-8", "replace")
+            pos += 2 + n
+            n = struct.unpack_from("<H", data, pos)[0]
+            file = data[pos + 2:pos + 2 + n].decode("utf-8", "replace")
+            pos += 2 + n
+            formats[fid] = (level, line, fmt, file)
+        elif kind == "M":
+            fid, timestamp, count, size = struct.unpack_from("<QIBH", data, pos)
+            pos += 15
+            args = read_args(data[pos:pos + size], count)
+            pos += size
+            level, line, fmt, file = formats.get(fid, (4, 0, "<unknown format %#x>" % fid, ""))
+            message = format_message(fmt, args)
+            if file:
+                out.write("[%s]\t(%d.%03d)\t%s \t(in %s line #%d)\n" % (
+                    LEVELS[min(level, 4)], timestamp // 1000, timestamp % 1000, message, file, line))
+            else:
+                out.write(message.rstrip("\n") + "\n")
+        else:
+            raise ValueError("corrupted log at offset %d" % (pos - 1))
+
+
+def main():
+    if len(sys.argv) > 1:
+        with open(sys.argv[1], "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(data, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
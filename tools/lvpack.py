@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Packs a directory tree into an asset pack for lvgl::misc::AssetPackFileSystem.
+
+Usage: lvpack.py [--align N] [--compress] input_dir output_file
+
+Author: Vincent Paeder
+License: MIT
+"""
+import argparse
+import os
+import struct
+
+MAGIC = b"LVPK"
+VERSION = 1
+FLAG_RLE = 1
+HEADER_SIZE = 16
+ENTRY_SIZE = 20
+
+
+def rle_encode(data):
+    """Encodes data in runs: control byte c < 128 followed by c+1 literal
+    bytes, or c >= 128 followed by one byte repeated c-126 times."""
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    n = len(data)
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:128]
+
+    while i < n:
+        run = 1
+        while i + run < n and run < 129 and data[i + run] == data[i]:
+            run += 1
+        if run >= 3:
+            flush()
+            out.append(run + 126)
+            out.append(data[i])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+    flush()
+    return bytes(out)
+
+
+def collect(root):
+    files = []
+    for dirpath, _, filenames in os.walk(root):
+        for name in filenames:
+            full = os.path.join(dirpath, name)
+            rel = os.path.relpath(full, root).replace(os.sep, "/")
+            files.append((rel, full))
+    # byte-wise order, as compared by the driver
+    files.sort(key=lambda f: f[0].encode("utf-8"))
+    return files
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input_dir")
+    parser.add_argument("output_file")
+    parser.add_argument("--align", type=int, default=4,
+                        help="entry data alignment, power of 2 (default: 4)")
+    parser.add_argument("--compress", action="store_true",
+                        help="RLE-compress entries when it makes them smaller")
+    args = parser.parse_args()
+    if args.align < 1 or args.align & (args.align - 1):
+        parser.error("alignment must be a power of 2")
+
+    files = collect(args.input_dir)
+    names = bytearray()
+    entries = []
+    for rel, full in files:
+        name = rel.encode("utf-8")
+        if len(name) > 0xFFFF:
+            parser.error("path too long: " + rel)
+        with open(full, "rb") as f:
+            raw = f.read()
+        stored, flags = raw, 0
+        if args.compress:
+            packed = rle_encode(raw)
+            if len(packed) < len(raw):
+                stored, flags = packed, FLAG_RLE
+        entries.append([len(names), len(name), flags, 0, stored, len(raw)])
+        names.extend(name)
+
+    offset = HEADER_SIZE + ENTRY_SIZE * len(entries) + len(names)
+    for entry in entries:
+        offset = (offset + args.align - 1) & ~(args.align - 1)
+        entry[3] = offset
+        offset += len(entry[4])
+    if offset > 0xFFFFFFFF:
+        parser.error("pack exceeds 4 GiB")
+
+    with open(args.output_file, "wb") as out:
+        out.write(MAGIC)
+        # reserved field: data alignment isn't needed to read the pack
+        out.write(struct.pack("<HHII", VERSION, 0, len(entries), len(names)))
+        for name_offset, name_len, flags, data_offset, stored, size in entries:
+            out.write(struct.pack("<IHHIII", name_offset, name_len, flags,
+                                  data_offset, len(stored), size))
+        out.write(names)
+        for entry in entries:
+            out.write(b"\0" * (entry[3] - out.tell()))
+            out.write(entry[4])
+
+    total = sum(e[5] for e in entries)
+    print("%d entries, %d bytes of data packed into %d bytes" % (len(entries), total, offset))
+
+
+if __name__ == "__main__":
+    main()